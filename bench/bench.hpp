@@ -0,0 +1,79 @@
+#ifndef INCLUDED_SAMWARRING_BENCH_BENCH_HPP
+#define INCLUDED_SAMWARRING_BENCH_BENCH_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Minimal helpers shared by the benchmark executables. Benchmarks are plain
+// programs that print one line per measurement; they are not run by ctest.
+namespace bench {
+
+using clock = std::chrono::steady_clock;
+
+// Runs `fn` once and returns the elapsed wall-clock time in seconds.
+template <class Fn>
+double time_seconds(Fn&& fn) {
+    auto start = clock::now();
+    fn();
+    auto stop = clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+// Prevents the compiler from optimizing away a computed value.
+template <class T>
+void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+// Prints "<name>: <ops/s> (<ns/op>)".
+inline void report_throughput(const std::string& name, std::size_t ops,
+                              double seconds) {
+    std::cout << std::left << std::setw(48) << name << std::right
+              << std::setw(10) << std::fixed << std::setprecision(2)
+              << (ops / seconds / 1e6) << " Mops/s" << std::setw(10)
+              << (seconds * 1e9 / ops) << " ns/op\n";
+}
+
+// Collects latency samples in nanoseconds and prints percentiles.
+class latency_histogram {
+  public:
+    void reserve(std::size_t n) {
+        samples_.reserve(n);
+    }
+
+    void record(std::int64_t nanoseconds) {
+        samples_.push_back(nanoseconds);
+    }
+
+    void report(const std::string& name) {
+        if (samples_.empty()) {
+            return;
+        }
+        std::sort(samples_.begin(), samples_.end());
+        std::cout << std::left << std::setw(48) << name << std::right;
+        for (double p : {0.5, 0.9, 0.99, 0.999}) {
+            auto index = static_cast<std::size_t>(p * (samples_.size() - 1));
+            std::cout << "  p" << std::defaultfloat << (p * 100) << "="
+                      << samples_[index] << "ns";
+        }
+        std::cout << "  max=" << samples_.back() << "ns\n";
+    }
+
+  private:
+    std::vector<std::int64_t> samples_;
+};
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,82 @@
+// Compares byte_ring_buffer against boxing each message into a std::string
+// and queueing it in an spsc_ring_buffer, which is how variable-length log
+// records were queued before byte_ring_buffer existed.
+//
+// One thread writes batches of messages and then reads them back, so the
+// measurement covers serialization, allocation and queue overhead, without
+// depending on how the scheduler interleaves two threads.
+#include "bench.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <samwarring/byte_ring_buffer.hpp>
+#include <samwarring/spsc_ring_buffer.hpp>
+#include <string>
+
+using namespace samwarring;
+
+namespace {
+
+// Formats a log-like message of varying length into `out`.
+std::size_t format_message(char* out, std::size_t size, std::uint64_t i) {
+    int n = std::snprintf(out, size, "seq=%llu level=info msg=%.*s",
+                          static_cast<unsigned long long>(i),
+                          static_cast<int>(i % 64), "................"
+                                                    "................"
+                                                    "................"
+                                                    "................");
+    return static_cast<std::size_t>(n) < size ? static_cast<std::size_t>(n)
+                                              : size - 1;
+}
+
+void string_queue(std::size_t messages, std::size_t batch) {
+    spsc_ring_buffer<std::string> queue{batch};
+    double seconds = bench::time_seconds([&] {
+        char line[128];
+        std::uint64_t bytes = 0;
+        std::string item;
+        for (std::size_t i = 0; i < messages; i += batch) {
+            for (std::size_t j = 0; j < batch; ++j) {
+                std::size_t n = format_message(line, sizeof(line), i + j);
+                queue.try_push(std::string(line, n));
+            }
+            for (std::size_t j = 0; j < batch; ++j) {
+                queue.try_pop(item);
+                bytes += item.size();
+            }
+        }
+        bench::do_not_optimize(bytes);
+    });
+    bench::report_throughput("spsc_ring_buffer<std::string>", messages,
+                             seconds);
+}
+
+void byte_queue(std::size_t messages, std::size_t batch) {
+    byte_ring_buffer<> queue{batch * 256};
+    double seconds = bench::time_seconds([&] {
+        std::uint64_t bytes = 0;
+        for (std::size_t i = 0; i < messages; i += batch) {
+            for (std::size_t j = 0; j < batch; ++j) {
+                auto span = queue.try_reserve(128);
+                queue.commit(format_message(
+                    reinterpret_cast<char*>(span.data()), span.size(), i + j));
+            }
+            for (std::size_t j = 0; j < batch; ++j) {
+                bytes += queue.try_peek().size();
+                queue.release();
+            }
+        }
+        bench::do_not_optimize(bytes);
+    });
+    bench::report_throughput("byte_ring_buffer", messages, seconds);
+}
+
+} // namespace
+
+int main() {
+    const std::size_t MESSAGES = 10'000'000;
+    const std::size_t BATCH = 256;
+
+    string_queue(MESSAGES, BATCH);
+    byte_queue(MESSAGES, BATCH);
+}
@@ -0,0 +1,109 @@
+// Measures how mpmc_ring_buffer scales with the number of threads, compared
+// to a ring_buffer behind one global mutex.
+//
+// For each thread count N, N/2 producers (at least 1) push items that N/2
+// consumers (at least 1) pop. The reported rate counts pushed-and-popped
+// items per second across all threads.
+#include "bench.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <samwarring/mpmc_ring_buffer.hpp>
+#include <samwarring/ring_buffer.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace samwarring;
+
+namespace {
+
+template <class T>
+class locked_ring_buffer {
+  public:
+    explicit locked_ring_buffer(std::size_t capacity) : buf_{capacity} {}
+
+    bool try_push(T item) {
+        std::lock_guard<std::mutex> lk{mtx_};
+        if (unread_ == buf_.capacity()) {
+            return false;
+        }
+        buf_.push_back(std::move(item));
+        ++unread_;
+        return true;
+    }
+
+    bool try_pop(T& item) {
+        std::lock_guard<std::mutex> lk{mtx_};
+        if (unread_ == 0) {
+            return false;
+        }
+        item = std::move(buf_[buf_.size() - unread_]);
+        --unread_;
+        return true;
+    }
+
+  private:
+    std::mutex mtx_;
+    ring_buffer<T> buf_;
+    std::size_t unread_{0};
+};
+
+template <class Queue>
+void scaling(const std::string& name, std::size_t threads,
+             std::size_t items_per_producer) {
+    std::size_t producers = std::max<std::size_t>(1, threads / 2);
+    std::size_t consumers = std::max<std::size_t>(1, threads - producers);
+    std::size_t total = producers * items_per_producer;
+    Queue queue{1024};
+    std::atomic<std::size_t> popped{0};
+
+    double seconds = bench::time_seconds([&] {
+        std::vector<std::thread> workers;
+        for (std::size_t p = 0; p < producers; ++p) {
+            workers.emplace_back([&] {
+                for (std::uint64_t i = 0; i < items_per_producer; ++i) {
+                    while (!queue.try_push(i)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (std::size_t c = 0; c < consumers; ++c) {
+            workers.emplace_back([&] {
+                std::uint64_t item;
+                std::uint64_t sum = 0;
+                while (popped.load(std::memory_order_relaxed) < total) {
+                    if (queue.try_pop(item)) {
+                        sum += item;
+                        popped.fetch_add(1, std::memory_order_relaxed);
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+                bench::do_not_optimize(sum);
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+    });
+    bench::report_throughput(name + " (" + std::to_string(producers) + "P/" +
+                                 std::to_string(consumers) + "C)",
+                             total, seconds);
+}
+
+} // namespace
+
+int main() {
+    const std::size_t ITEMS_PER_PRODUCER = 1'000'000;
+    std::size_t max_threads =
+        std::max<unsigned>(2, std::thread::hardware_concurrency());
+
+    for (std::size_t n = 2; n <= max_threads; n *= 2) {
+        scaling<locked_ring_buffer<std::uint64_t>>("mutex + ring_buffer", n,
+                                                   ITEMS_PER_PRODUCER);
+        scaling<mpmc_ring_buffer<std::uint64_t>>("mpmc_ring_buffer", n,
+                                                 ITEMS_PER_PRODUCER);
+    }
+}
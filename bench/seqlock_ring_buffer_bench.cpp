@@ -0,0 +1,77 @@
+// Measures the writer of a metrics ring while reader threads keep taking
+// snapshots of it. The seqlock ring never makes the writer wait, while a
+// ring_buffer behind a mutex makes the writer queue behind every snapshot.
+#include "bench.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <samwarring/ring_buffer.hpp>
+#include <samwarring/seqlock_ring_buffer.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace samwarring;
+
+namespace {
+
+struct sample {
+    std::uint64_t time;
+    double value;
+};
+
+template <class Write, class Read>
+void run(const std::string& name, std::size_t pushes, int readers,
+         Write write, Read read) {
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&] {
+            while (!done.load(std::memory_order_relaxed)) {
+                read();
+            }
+        });
+    }
+    double seconds = bench::time_seconds([&] {
+        for (std::size_t i = 0; i < pushes; ++i) {
+            write(sample{i, static_cast<double>(i)});
+        }
+    });
+    done = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    bench::report_throughput(name + ", " + std::to_string(readers) +
+                                 " readers",
+                             pushes, seconds);
+}
+
+} // namespace
+
+int main() {
+    const std::size_t PUSHES = 5'000'000;
+    const std::size_t CAPACITY = 1024;
+
+    for (int readers : {0, 2}) {
+        ring_buffer<sample> ring{CAPACITY};
+        std::mutex mutex;
+        run(
+            "ring_buffer + mutex", PUSHES, readers,
+            [&](const sample& s) {
+                std::lock_guard<std::mutex> lock{mutex};
+                ring.push_back(s);
+            },
+            [&] {
+                std::vector<sample> copy;
+                std::lock_guard<std::mutex> lock{mutex};
+                copy.assign(ring.begin(), ring.end());
+                bench::do_not_optimize(copy.data());
+            });
+
+        seqlock_ring_buffer<sample> seqlock{CAPACITY};
+        run(
+            "seqlock_ring_buffer", PUSHES, readers,
+            [&](const sample& s) { seqlock.push_back(s); },
+            [&] { bench::do_not_optimize(seqlock.snapshot().data()); });
+    }
+}
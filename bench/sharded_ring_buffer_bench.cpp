@@ -0,0 +1,69 @@
+// Compares several threads recording events into a sharded_ring_buffer
+// against the same threads sharing one ring_buffer behind a mutex.
+#include "bench.hpp"
+#include <cstdint>
+#include <mutex>
+#include <samwarring/ring_buffer.hpp>
+#include <samwarring/sharded_ring_buffer.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace samwarring;
+
+namespace {
+
+template <class Fn>
+double run_threads(unsigned thread_count, Fn fn) {
+    return bench::time_seconds([&] {
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < thread_count; ++t) {
+            threads.emplace_back(fn);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    });
+}
+
+void shared_ring(unsigned thread_count, std::size_t pushes) {
+    ring_buffer<std::uint64_t> ring{4096};
+    std::mutex mutex;
+    double seconds = run_threads(thread_count, [&] {
+        for (std::size_t i = 0; i < pushes; ++i) {
+            std::lock_guard<std::mutex> lock{mutex};
+            ring.push_back(i);
+        }
+    });
+    bench::report_throughput("ring_buffer + mutex, " +
+                                 std::to_string(thread_count) + " threads",
+                             thread_count * pushes, seconds);
+}
+
+void sharded_ring(unsigned thread_count, std::size_t pushes) {
+    sharded_ring_buffer<std::uint64_t> ring{4096, thread_count};
+    double seconds = run_threads(thread_count, [&] {
+        for (std::size_t i = 0; i < pushes; ++i) {
+            ring.push_back(i);
+        }
+    });
+    bench::report_throughput("sharded_ring_buffer, " +
+                                 std::to_string(thread_count) + " threads",
+                             thread_count * pushes, seconds);
+
+    std::size_t entries = 0;
+    seconds = bench::time_seconds(
+        [&] { ring.for_each([&](const auto&) { ++entries; }); });
+    bench::report_throughput("sharded_ring_buffer merged read", entries,
+                             seconds);
+}
+
+} // namespace
+
+int main() {
+    const std::size_t PUSHES = 2'000'000;
+    const unsigned THREADS = sharded_ring_buffer<int>::default_shard_count();
+
+    shared_ring(THREADS, PUSHES);
+    sharded_ring(THREADS, PUSHES);
+}
@@ -0,0 +1,141 @@
+// Compares shm_spsc_ring_buffer against a Unix domain socket, which is how the
+// collector and exporter processes exchanged records before.
+//
+// The parent process produces N records and a forked child consumes them.
+// The socket baseline writes and reads records in batches, so each batch
+// costs two copies and two system calls. Throughput covers the whole run,
+// from the first record written to the child exiting.
+#include "bench.hpp"
+#include <cstdint>
+#include <samwarring/shm_spsc_ring_buffer.hpp>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace samwarring;
+
+namespace {
+
+struct record {
+    std::uint64_t seq;
+    std::uint64_t timestamp;
+    double values[6];
+};
+
+void wait_for(pid_t pid) {
+    int status;
+    ::waitpid(pid, &status, 0);
+}
+
+void shm_throughput(std::size_t capacity, std::size_t records) {
+    const std::string name = "/samwarring_shm_bench_" +
+                             std::to_string(::getpid());
+    shm_spsc_ring_buffer<record>::remove(name);
+    shm_spsc_ring_buffer<record> queue{name, capacity};
+
+    double seconds = bench::time_seconds([&] {
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            shm_spsc_ring_buffer<record> consumer{name};
+            std::uint64_t sum = 0;
+            for (std::size_t i = 0; i < records; ++i) {
+                const record* r = consumer.peek();
+                sum += r->seq;
+                consumer.release();
+            }
+            bench::do_not_optimize(sum);
+            ::_exit(0);
+        }
+        for (std::size_t i = 0; i < records; ++i) {
+            record* r = queue.reserve();
+            r->seq = i;
+            r->timestamp = i;
+            queue.commit();
+        }
+        wait_for(pid);
+    });
+    shm_spsc_ring_buffer<record>::remove(name);
+    bench::report_throughput("shm_spsc_ring_buffer (capacity " +
+                                 std::to_string(capacity) + ")",
+                             records, seconds);
+}
+
+bool write_all(int fd, const void* data, std::size_t bytes) {
+    auto* p = static_cast<const char*>(data);
+    while (bytes) {
+        ssize_t n = ::write(fd, p, bytes);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        bytes -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool read_all(int fd, void* data, std::size_t bytes) {
+    auto* p = static_cast<char*>(data);
+    while (bytes) {
+        ssize_t n = ::read(fd, p, bytes);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        bytes -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+void socket_throughput(std::size_t batch, std::size_t records) {
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+        return;
+    }
+    double seconds = bench::time_seconds([&] {
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            ::close(fds[0]);
+            std::vector<record> buf(batch);
+            std::uint64_t sum = 0;
+            for (std::size_t i = 0; i < records; i += batch) {
+                if (!read_all(fds[1], buf.data(), batch * sizeof(record))) {
+                    ::_exit(1);
+                }
+                for (const record& r : buf) {
+                    sum += r.seq;
+                }
+            }
+            bench::do_not_optimize(sum);
+            ::_exit(0);
+        }
+        std::vector<record> buf(batch);
+        for (std::size_t i = 0; i < records; i += batch) {
+            for (std::size_t j = 0; j < batch; ++j) {
+                buf[j].seq = i + j;
+                buf[j].timestamp = i + j;
+            }
+            write_all(fds[0], buf.data(), batch * sizeof(record));
+        }
+        wait_for(pid);
+    });
+    ::close(fds[0]);
+    ::close(fds[1]);
+    bench::report_throughput("unix socket (batch " + std::to_string(batch) +
+                                 ")",
+                             records, seconds);
+}
+
+} // namespace
+
+int main() {
+    const std::size_t RECORDS = 4'000'000;
+
+    for (std::size_t batch : {1, 64}) {
+        socket_throughput(batch, RECORDS);
+    }
+    for (std::size_t capacity : {64, 4096}) {
+        shm_throughput(capacity, RECORDS);
+    }
+}
@@ -0,0 +1,87 @@
+// Compares the simd kernels over ring_buffer partitions against the same
+// reductions written with the ordered ring_buffer iterator.
+#include "bench.hpp"
+#include <cstdint>
+#include <samwarring/ring_buffer.hpp>
+#include <samwarring/simd_kernels.hpp>
+#include <string>
+#include <vector>
+
+using namespace samwarring;
+
+namespace {
+
+const char* name(simd::instruction_set isa) {
+    switch (isa) {
+    case simd::instruction_set::avx2:
+        return "avx2";
+    case simd::instruction_set::sse2:
+        return "sse2";
+    case simd::instruction_set::scalar:
+        break;
+    }
+    return "scalar";
+}
+
+template <class T>
+void run(const std::string& type, std::size_t window, std::size_t passes) {
+    ring_buffer<T> buf{window};
+    for (std::size_t i = 0; i < window + window / 3; ++i) {
+        buf.push_back(static_cast<T>(i % 1000));
+    }
+    std::vector<T> kernel(window, T{1});
+    const std::string suffix = " " + type + " (window " +
+                               std::to_string(window) + ")";
+
+    double seconds = bench::time_seconds([&] {
+        for (std::size_t p = 0; p < passes; ++p) {
+            simd::accumulator_t<T> total{0};
+            for (const T& v : buf) {
+                total += v;
+            }
+            bench::do_not_optimize(total);
+        }
+    });
+    bench::report_throughput("iterator sum" + suffix, window * passes,
+                             seconds);
+
+    seconds = bench::time_seconds([&] {
+        for (std::size_t p = 0; p < passes; ++p) {
+            bench::do_not_optimize(simd::sum(buf));
+        }
+    });
+    bench::report_throughput("simd sum" + suffix, window * passes, seconds);
+
+    seconds = bench::time_seconds([&] {
+        for (std::size_t p = 0; p < passes; ++p) {
+            simd::accumulator_t<T> total{0};
+            std::size_t i = 0;
+            for (const T& v : buf) {
+                total += v * kernel[i++];
+            }
+            bench::do_not_optimize(total);
+        }
+    });
+    bench::report_throughput("iterator dot" + suffix, window * passes,
+                             seconds);
+
+    seconds = bench::time_seconds([&] {
+        for (std::size_t p = 0; p < passes; ++p) {
+            bench::do_not_optimize(simd::dot(buf, kernel.data()));
+        }
+    });
+    bench::report_throughput("simd dot" + suffix, window * passes, seconds);
+}
+
+} // namespace
+
+int main() {
+    std::cout << "instruction set: " << name(simd::best_instruction_set())
+              << "\n";
+    for (std::size_t window : {256, 4096, 65536}) {
+        const std::size_t passes = 100'000'000 / window;
+        run<float>("float", window, passes);
+        run<double>("double", window, passes);
+        run<std::int32_t>("int32", window, passes);
+    }
+}
@@ -0,0 +1,109 @@
+// Measures reading reference_counted_singleton, borrowed_singleton and
+// rcu_singleton while the object stays alive, from 1 to 64 threads,
+// against the previous implementation that took a mutex on every call.
+// Then measures counter increments on a singleton against a
+// sharded_singleton.
+#include "bench.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <samwarring/rcu_singleton.hpp>
+#include <samwarring/singleton.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace samwarring;
+
+namespace {
+
+struct service {
+    int value{0};
+};
+
+// The previous implementation, without its teardown handling, which this
+// benchmark does not exercise.
+std::shared_ptr<service> locked_singleton() {
+    static std::weak_ptr<service> instance;
+    static std::mutex mtx;
+    std::lock_guard<std::mutex> lk{mtx};
+    std::shared_ptr<service> shared = instance.lock();
+    if (!shared) {
+        shared = std::make_shared<service>();
+        instance = shared;
+    }
+    return shared;
+}
+
+struct counter {
+    std::atomic<std::uint64_t> count{0};
+};
+
+template <class Fn>
+double run_threads(unsigned threads, Fn fn) {
+    return bench::time_seconds([&] {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back(fn);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    });
+}
+
+template <class Get>
+void run(const std::string& name, unsigned threads, std::size_t calls,
+         Get get) {
+    // Keeps the object alive, so every call finds it.
+    auto keep_alive = get();
+    double seconds = run_threads(threads, [&] {
+        for (std::size_t i = 0; i < calls; ++i) {
+            bench::do_not_optimize(get()->value);
+        }
+    });
+    bench::report_throughput(name + ", " + std::to_string(threads) +
+                                 " threads",
+                             threads * calls, seconds);
+}
+
+} // namespace
+
+int main() {
+    const std::size_t TOTAL_CALLS = 4'000'000;
+
+    for (unsigned threads : {1, 2, 4, 8, 16, 32, 64}) {
+        run("mutex on every call", threads, TOTAL_CALLS / threads,
+            locked_singleton);
+        run("reference_counted_singleton", threads, TOTAL_CALLS / threads,
+            reference_counted_singleton<service>);
+        run("borrowed_singleton", threads, TOTAL_CALLS / threads,
+            [] { return borrowed_singleton<service>{}; });
+        run("rcu_singleton", threads, TOTAL_CALLS / threads,
+            rcu_singleton<service>::read);
+    }
+
+    for (unsigned threads : {1, 2, 4, 8, 16, 32, 64}) {
+        const std::size_t calls = TOTAL_CALLS / threads;
+        double seconds = run_threads(threads, [&] {
+            for (std::size_t i = 0; i < calls; ++i) {
+                singleton<counter>().count.fetch_add(
+                    1, std::memory_order_relaxed);
+            }
+        });
+        bench::report_throughput("singleton counter, " +
+                                     std::to_string(threads) + " threads",
+                                 threads * calls, seconds);
+
+        seconds = run_threads(threads, [&] {
+            for (std::size_t i = 0; i < calls; ++i) {
+                sharded_singleton<counter>::local().count.fetch_add(
+                    1, std::memory_order_relaxed);
+            }
+        });
+        bench::report_throughput("sharded_singleton counter, " +
+                                     std::to_string(threads) + " threads",
+                                 threads * calls, seconds);
+    }
+}
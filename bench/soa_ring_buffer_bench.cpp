@@ -0,0 +1,68 @@
+// Compares summing one field of a window of records stored as an array of
+// structs (ring_buffer<record>) against a structure of arrays
+// (soa_ring_buffer), where the scan only streams that field's bytes.
+#include "bench.hpp"
+#include <cstdint>
+#include <samwarring/ring_buffer.hpp>
+#include <samwarring/simd_kernels.hpp>
+#include <samwarring/soa_ring_buffer.hpp>
+
+using namespace samwarring;
+
+namespace {
+
+struct record {
+    std::int64_t timestamp;
+    double value;
+    std::uint32_t flags;
+};
+
+} // namespace
+
+int main() {
+    const std::size_t WINDOW = 1 << 20;
+    const std::size_t PASSES = 200;
+
+    ring_buffer<record> aos{WINDOW};
+    soa_ring_buffer<std::int64_t, double, std::uint32_t> soa{WINDOW};
+    for (std::size_t i = 0; i < WINDOW + WINDOW / 3; ++i) {
+        const auto t = static_cast<std::int64_t>(i);
+        aos.push_back(record{t, i * 0.25, 0});
+        soa.push_back(t, i * 0.25, 0);
+    }
+
+    double seconds = bench::time_seconds([&] {
+        for (std::size_t pass = 0; pass < PASSES; ++pass) {
+            double total = 0;
+            for (const record& r : aos) {
+                total += r.value;
+            }
+            bench::do_not_optimize(total);
+        }
+    });
+    bench::report_throughput("ring_buffer<record> sum of value",
+                             WINDOW * PASSES, seconds);
+
+    seconds = bench::time_seconds([&] {
+        for (std::size_t pass = 0; pass < PASSES; ++pass) {
+            double total = 0;
+            auto values = soa.column<1>();
+            for (auto part : {values.first_part(), values.second_part()}) {
+                for (double v : part) {
+                    total += v;
+                }
+            }
+            bench::do_not_optimize(total);
+        }
+    });
+    bench::report_throughput("soa_ring_buffer sum of value, scalar",
+                             WINDOW * PASSES, seconds);
+
+    seconds = bench::time_seconds([&] {
+        for (std::size_t pass = 0; pass < PASSES; ++pass) {
+            bench::do_not_optimize(simd::sum(soa.column<1>()));
+        }
+    });
+    bench::report_throughput("soa_ring_buffer sum of value, simd::sum",
+                             WINDOW * PASSES, seconds);
+}
@@ -0,0 +1,153 @@
+// Compares spsc_ring_buffer against a mutex-protected ring_buffer, which is
+// how samples were passed between threads before spsc_ring_buffer existed.
+//
+// Throughput: a producer thread pushes N items that a consumer thread pops,
+// either one at a time or in batches with consume_batch.
+// Latency: two queues form a ping-pong loop; half of each round trip is
+// recorded as the one-way latency.
+#include "bench.hpp"
+#include <cstdint>
+#include <mutex>
+#include <samwarring/ring_buffer.hpp>
+#include <samwarring/spsc_ring_buffer.hpp>
+#include <thread>
+
+using namespace samwarring;
+
+namespace {
+
+// ring_buffer overwrites the oldest item, so callers that need queue semantics
+// track the number of unread items themselves.
+template <class T>
+class locked_ring_buffer {
+  public:
+    explicit locked_ring_buffer(std::size_t capacity) : buf_{capacity} {}
+
+    bool try_push(T item) {
+        std::lock_guard<std::mutex> lk{mtx_};
+        if (unread_ == buf_.capacity()) {
+            return false;
+        }
+        buf_.push_back(std::move(item));
+        ++unread_;
+        return true;
+    }
+
+    bool try_pop(T& item) {
+        std::lock_guard<std::mutex> lk{mtx_};
+        if (unread_ == 0) {
+            return false;
+        }
+        item = std::move(buf_[buf_.size() - unread_]);
+        --unread_;
+        return true;
+    }
+
+  private:
+    std::mutex mtx_;
+    ring_buffer<T> buf_;
+    std::size_t unread_{0};
+};
+
+template <class Queue>
+void throughput(const char* name, std::size_t capacity, std::size_t items) {
+    Queue queue{capacity};
+    double seconds = bench::time_seconds([&] {
+        std::thread producer{[&] {
+            for (std::uint64_t i = 0; i < items; ++i) {
+                while (!queue.try_push(i)) {
+                }
+            }
+        }};
+        std::uint64_t item = 0;
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i < items; ++i) {
+            while (!queue.try_pop(item)) {
+            }
+            sum += item;
+        }
+        producer.join();
+        bench::do_not_optimize(sum);
+    });
+    bench::report_throughput(name, items, seconds);
+}
+
+void batch_throughput(const char* name, std::size_t capacity,
+                      std::size_t items, std::size_t batch) {
+    spsc_ring_buffer<std::uint64_t> queue{capacity};
+    double seconds = bench::time_seconds([&] {
+        std::thread producer{[&] {
+            for (std::uint64_t i = 0; i < items; ++i) {
+                while (!queue.try_push(i)) {
+                }
+            }
+        }};
+        std::uint64_t sum = 0;
+        for (std::size_t consumed = 0; consumed < items;) {
+            consumed += queue.consume_batch(
+                batch, [&](std::uint64_t* begin, std::uint64_t* end) {
+                    for (; begin != end; ++begin) {
+                        sum += *begin;
+                    }
+                });
+        }
+        producer.join();
+        bench::do_not_optimize(sum);
+    });
+    bench::report_throughput(name, items, seconds);
+}
+
+template <class Queue>
+void latency(const char* name, std::size_t round_trips) {
+    Queue ping{64};
+    Queue pong{64};
+    std::thread echo{[&] {
+        std::uint64_t item;
+        for (std::size_t i = 0; i < round_trips; ++i) {
+            while (!ping.try_pop(item)) {
+            }
+            while (!pong.try_push(item)) {
+            }
+        }
+    }};
+
+    bench::latency_histogram hist;
+    hist.reserve(round_trips);
+    std::uint64_t item;
+    for (std::size_t i = 0; i < round_trips; ++i) {
+        auto start = bench::clock::now();
+        while (!ping.try_push(i)) {
+        }
+        while (!pong.try_pop(item)) {
+        }
+        auto stop = bench::clock::now();
+        hist.record(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start)
+                .count() /
+            2);
+    }
+    echo.join();
+    hist.report(name);
+}
+
+} // namespace
+
+int main() {
+    const std::size_t ITEMS = 10'000'000;
+    const std::size_t ROUND_TRIPS = 200'000;
+
+    for (std::size_t capacity : {64, 1024, 65536}) {
+        std::string suffix = " (capacity " + std::to_string(capacity) + ")";
+        throughput<locked_ring_buffer<std::uint64_t>>(
+            ("mutex + ring_buffer" + suffix).c_str(), capacity, ITEMS);
+        throughput<spsc_ring_buffer<std::uint64_t>>(
+            ("spsc_ring_buffer" + suffix).c_str(), capacity, ITEMS);
+        batch_throughput(("spsc_ring_buffer consume_batch" + suffix).c_str(),
+                         capacity, ITEMS, 256);
+    }
+
+    latency<locked_ring_buffer<std::uint64_t>>("mutex + ring_buffer latency",
+                                               ROUND_TRIPS);
+    latency<spsc_ring_buffer<std::uint64_t>>("spsc_ring_buffer latency",
+                                             ROUND_TRIPS);
+}
@@ -0,0 +1,81 @@
+// Measures the wakeup latency of each wait strategy, and the CPU time the
+// waiting thread burns to get it.
+//
+// A producer pushes a timestamp into an spsc_ring_buffer every PERIOD, and a
+// consumer blocked in pop() records how long after the timestamp it received
+// the item. The gap between items is long enough for the sleeping strategies
+// to fall asleep, so their wakeup cost is included.
+#include "bench.hpp"
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <samwarring/spsc_ring_buffer.hpp>
+#include <samwarring/wait_strategy.hpp>
+#include <string>
+#include <thread>
+
+using namespace samwarring;
+
+namespace {
+
+// CPU time consumed by the calling thread, in seconds.
+double thread_cpu_seconds() {
+#if defined(__unix__)
+    struct timespec ts;
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + ts.tv_nsec * 1e-9;
+#else
+    return 0;
+#endif
+}
+
+template <class WaitStrategy>
+void wakeup_latency(const char* name, std::size_t samples,
+                    std::chrono::microseconds period) {
+    spsc_ring_buffer<bench::clock::time_point, WaitStrategy> queue{64};
+    bench::latency_histogram hist;
+    hist.reserve(samples);
+    double consumer_cpu = 0;
+
+    std::thread consumer{[&] {
+        const double cpu_start = thread_cpu_seconds();
+        bench::clock::time_point sent;
+        for (std::size_t i = 0; i < samples; ++i) {
+            queue.pop(sent);
+            const auto received = bench::clock::now();
+            hist.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            received - sent)
+                            .count());
+        }
+        consumer_cpu = thread_cpu_seconds() - cpu_start;
+    }};
+
+    const auto start = bench::clock::now();
+    for (std::size_t i = 0; i < samples; ++i) {
+        std::this_thread::sleep_for(period);
+        queue.push(bench::clock::now());
+    }
+    consumer.join();
+    const double wall =
+        std::chrono::duration<double>(bench::clock::now() - start).count();
+
+    hist.report(name);
+    std::cout << "    consumer CPU: " << std::fixed << std::setprecision(1)
+              << (100 * consumer_cpu / wall) << "% of one core\n";
+}
+
+} // namespace
+
+int main() {
+    const std::size_t SAMPLES = 20'000;
+    const std::chrono::microseconds PERIOD{50};
+
+    wakeup_latency<busy_spin>("busy_spin", SAMPLES, PERIOD);
+    wakeup_latency<spin_yield<>>("spin_yield", SAMPLES, PERIOD);
+#if defined(__linux__)
+    wakeup_latency<spin_futex<>>("spin_futex", SAMPLES, PERIOD);
+#endif
+    wakeup_latency<timed_wait<>>("timed_wait (50us)", SAMPLES, PERIOD);
+}
@@ -0,0 +1,73 @@
+// Compares windowed_stats_ring against rescanning a ring_buffer after every
+// push to compute the sum, min and max of the window.
+#include "bench.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <samwarring/ring_buffer.hpp>
+#include <samwarring/windowed_stats_ring.hpp>
+#include <string>
+#include <vector>
+
+using namespace samwarring;
+
+namespace {
+
+std::vector<double> make_samples(std::size_t n) {
+    std::mt19937 rng{42};
+    std::uniform_real_distribution<double> dist{0.0, 1000.0};
+    std::vector<double> samples(n);
+    for (auto& s : samples) {
+        s = dist(rng);
+    }
+    return samples;
+}
+
+void rescan(std::size_t window, const std::vector<double>& samples) {
+    ring_buffer<double> buf{window};
+    double checksum = 0;
+    double seconds = bench::time_seconds([&] {
+        for (double s : samples) {
+            buf.push_back(s);
+            double sum = 0;
+            double lo = buf[0];
+            double hi = buf[0];
+            for (double v : buf) {
+                sum += v;
+                lo = std::min(lo, v);
+                hi = std::max(hi, v);
+            }
+            checksum += sum + lo + hi;
+        }
+    });
+    bench::do_not_optimize(checksum);
+    bench::report_throughput("rescan (window " + std::to_string(window) + ")",
+                             samples.size(), seconds);
+}
+
+void incremental(std::size_t window, const std::vector<double>& samples) {
+    windowed_stats_ring<double> stats{window};
+    double checksum = 0;
+    double seconds = bench::time_seconds([&] {
+        for (double s : samples) {
+            stats.push_back(s);
+            checksum += stats.sum() + stats.min() + stats.max();
+        }
+    });
+    bench::do_not_optimize(checksum);
+    bench::report_throughput("windowed_stats_ring (window " +
+                                 std::to_string(window) + ")",
+                             samples.size(), seconds);
+}
+
+} // namespace
+
+int main() {
+    for (std::size_t window : {16, 256, 4096}) {
+        // Keep the rescan's total work roughly constant across window sizes.
+        auto samples = make_samples(std::max<std::size_t>(
+            10'000, 200'000'000 / window));
+        rescan(window, samples);
+        incremental(window, samples);
+    }
+}
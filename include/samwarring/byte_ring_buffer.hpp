@@ -0,0 +1,351 @@
+#ifndef INCLUDED_SAMWARRING_BYTE_RING_BUFFER_HPP
+#define INCLUDED_SAMWARRING_BYTE_RING_BUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <samwarring/detail/cache_line.hpp>
+#include <samwarring/detail/power_of_two.hpp>
+#include <samwarring/wait_strategy.hpp>
+#include <stdexcept>
+
+namespace samwarring {
+
+/**
+ * @brief Queue of variable-length byte records for one producer thread and
+ * one consumer thread, serialized directly into a ring of bytes.
+ *
+ * Each record is stored as an 8-byte header holding its length, followed by
+ * its payload, padded so that the next header is 8-byte aligned. Payloads
+ * are therefore 8-byte aligned too. A record never wraps around the end of
+ * the storage. When it does not fit before the end, the producer writes a
+ * padding marker in place of a header, and the record starts over at the
+ * beginning of the storage. The consumer skips the marker.
+ *
+ * The producer serializes a record in place:
+ *
+ * 1. try_reserve(n) (or the blocking reserve(n)) returns a writable span of
+ *    `n` bytes, or an empty span if there is not enough room yet.
+ * 2. The producer writes up to `n` bytes into the span.
+ * 3. commit(m) publishes the first `m <= n` bytes as one record.
+ *
+ * The consumer reads it in place:
+ *
+ * 1. try_peek() (or the blocking peek()) returns the oldest record, or an
+ *    empty span if there is none.
+ * 2. release() removes the record and frees its bytes for the producer.
+ *
+ * Records never touch the heap, and a record is never copied by the queue.
+ * Like @ref spsc_ring_buffer, the tail and head live on separate cache lines
+ * next to private copies of each other, and the blocking functions wait with
+ * `WaitStrategy`.
+ *
+ * The capacity is rounded up to a power of two of at least 64 bytes. Records
+ * may be up to max_record_size() bytes, which is half the capacity minus the
+ * header. This bound guarantees that a record always fits once the queue is
+ * empty, wherever the empty queue happens to start.
+ *
+ * Example
+ * -------
+ *
+ *      byte_ring_buffer<> log{1 << 20};
+ *
+ *      // Producer thread
+ *      auto span = log.reserve(max_message_size);
+ *      std::size_t n = format_message(span.data(), span.size());
+ *      log.commit(n);
+ *
+ *      // Consumer thread
+ *      auto record = log.peek();
+ *      write(fd, record.data(), record.size());
+ *      log.release();
+ *
+ * @tparam WaitStrategy How the blocking functions wait.
+ */
+template <class WaitStrategy = busy_spin>
+class alignas(detail::cache_line_size) byte_ring_buffer {
+  public:
+    /**
+     * @brief Contiguous range of bytes in the ring.
+     *
+     * A default-constructed span is empty and converts to false. A span
+     * returned for a zero-length record converts to true.
+     */
+    template <class U>
+    class span_base {
+      public:
+        span_base() noexcept = default;
+
+        U* data() const noexcept {
+            return data_;
+        }
+
+        std::size_t size() const noexcept {
+            return size_;
+        }
+
+        U* begin() const noexcept {
+            return data_;
+        }
+
+        U* end() const noexcept {
+            return data_ + size_;
+        }
+
+        explicit operator bool() const noexcept {
+            return data_ != nullptr;
+        }
+
+      private:
+        friend class byte_ring_buffer;
+        span_base(U* data, std::size_t size) noexcept
+            : data_{data}, size_{size} {}
+
+        U* data_{nullptr};
+        std::size_t size_{0};
+    };
+
+    using mutable_span = span_base<unsigned char>;
+    using const_span = span_base<const unsigned char>;
+
+    /**
+     * @brief Size of the header in front of each record, and the alignment of
+     * each record.
+     */
+    static constexpr std::size_t header_size = 8;
+
+    /**
+     * @brief Constructs an empty queue.
+     *
+     * @param capacity Minimum number of bytes in the ring, including record
+     * headers and padding. It is rounded up to a power of two of at least 64.
+     */
+    explicit byte_ring_buffer(std::size_t capacity)
+        : mask_{detail::round_up_to_power_of_two(capacity, 64) - 1},
+          words_{std::allocator<std::uint64_t>{}.allocate((mask_ + 1) / 8)},
+          data_{reinterpret_cast<unsigned char*>(words_)} {}
+
+    byte_ring_buffer(const byte_ring_buffer&) = delete;
+    byte_ring_buffer(byte_ring_buffer&&) = delete;
+    byte_ring_buffer& operator=(const byte_ring_buffer&) = delete;
+    byte_ring_buffer& operator=(byte_ring_buffer&&) = delete;
+
+    ~byte_ring_buffer() {
+        std::allocator<std::uint64_t>{}.deallocate(words_, (mask_ + 1) / 8);
+    }
+
+    /**
+     * @return Number of bytes in the ring.
+     */
+    std::size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    /**
+     * @return Largest record that can be reserved.
+     */
+    std::size_t max_record_size() const noexcept {
+        return capacity() / 2 - header_size;
+    }
+
+    /**
+     * @return true if the queue holds no records. Only a snapshot while the
+     * other thread is active.
+     */
+    bool empty() const noexcept {
+        return head_.load(std::memory_order_acquire) ==
+               tail_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @name Producer functions
+     * @{
+     */
+
+    /**
+     * @brief Reserves room for a record of up to `size` bytes.
+     *
+     * Nothing is visible to the consumer until commit() is called. Calling
+     * try_reserve again before commit replaces the reservation.
+     *
+     * @return Writable span of `size` bytes, or an empty span if the queue
+     * does not have room yet.
+     * @throws std::length_error if `size` exceeds max_record_size().
+     */
+    mutable_span try_reserve(std::size_t size) {
+        check_record_size(size);
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        const std::size_t index = tail & mask_;
+        const std::size_t until_end = capacity() - index;
+        const std::size_t footprint = record_footprint(size);
+        const std::size_t needed =
+            footprint <= until_end ? footprint : until_end + footprint;
+        if (capacity() - (tail - head_cache_) < needed) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (capacity() - (tail - head_cache_) < needed) {
+                return {};
+            }
+        }
+        if (footprint <= until_end) {
+            reserved_ = tail;
+        } else {
+            // The record starts over at the beginning of the storage.
+            write_header(index, padding_marker);
+            reserved_ = tail + until_end;
+        }
+        return {data_ + (reserved_ & mask_) + header_size, size};
+    }
+
+    /**
+     * @brief Reserves room for a record of up to `size` bytes, waiting while
+     * the queue does not have room.
+     *
+     * @throws std::length_error if `size` exceeds max_record_size().
+     */
+    mutable_span reserve(std::size_t size) {
+        check_record_size(size);
+        mutable_span span;
+        not_full_.wait(
+            [&] { return static_cast<bool>(span = try_reserve(size)); });
+        return span;
+    }
+
+    /**
+     * @brief Publishes the first `size` bytes of the reserved span as one
+     * record.
+     *
+     * @param size Length of the record. Must not exceed the size passed to
+     * the reservation.
+     */
+    void commit(std::size_t size) noexcept {
+        write_header(reserved_ & mask_, size);
+        tail_.store(reserved_ + record_footprint(size),
+                    std::memory_order_release);
+        not_empty_.notify();
+    }
+
+    /**
+     * @brief Copies a record into the queue.
+     *
+     * @return true if the record was pushed, or false if the queue did not
+     * have room.
+     * @throws std::length_error if `size` exceeds max_record_size().
+     */
+    bool try_push(const void* data, std::size_t size) {
+        mutable_span span = try_reserve(size);
+        if (!span) {
+            return false;
+        }
+        if (size) {
+            std::memcpy(span.data(), data, size);
+        }
+        commit(size);
+        return true;
+    }
+
+    /**
+     * @} End of Producer functions
+     */
+
+    /**
+     * @name Consumer functions
+     * @{
+     */
+
+    /**
+     * @brief Returns the oldest record, or an empty span if the queue is
+     * empty.
+     *
+     * The record stays in the queue until release() is called.
+     */
+    const_span try_peek() noexcept {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return {};
+            }
+        }
+        std::uint64_t header = read_header(head & mask_);
+        if (header == padding_marker) {
+            // The producer committed the record after the marker together
+            // with the marker, so it is ready too.
+            head += capacity() - (head & mask_);
+            header = read_header(0);
+        }
+        const auto size = static_cast<std::size_t>(header);
+        read_end_ = head + record_footprint(size);
+        return {data_ + (head & mask_) + header_size, size};
+    }
+
+    /**
+     * @brief Returns the oldest record, waiting while the queue is empty.
+     */
+    const_span peek() noexcept {
+        const_span span;
+        not_empty_.wait([&] { return static_cast<bool>(span = try_peek()); });
+        return span;
+    }
+
+    /**
+     * @brief Removes the record returned by the last try_peek() or peek(),
+     * freeing its bytes for the producer.
+     */
+    void release() noexcept {
+        head_.store(read_end_, std::memory_order_release);
+        not_full_.notify();
+    }
+
+    /**
+     * @} End of Consumer functions
+     */
+
+  private:
+    // Never a valid length, since records are at most half the capacity.
+    static constexpr std::uint64_t padding_marker = ~std::uint64_t{0};
+
+    static std::size_t record_footprint(std::size_t size) noexcept {
+        return (header_size + size + header_size - 1) & ~(header_size - 1);
+    }
+
+    void check_record_size(std::size_t size) const {
+        if (size > max_record_size()) {
+            throw std::length_error{"record exceeds max_record_size()"};
+        }
+    }
+
+    void write_header(std::size_t index, std::uint64_t size) noexcept {
+        std::memcpy(data_ + index, &size, sizeof(size));
+    }
+
+    std::uint64_t read_header(std::size_t index) const noexcept {
+        std::uint64_t size;
+        std::memcpy(&size, data_ + index, sizeof(size));
+        return size;
+    }
+
+    // Read-only after construction. Storage is allocated as 64-bit words so
+    // that every record header and payload is 8-byte aligned.
+    const std::size_t mask_;
+    std::uint64_t* const words_;
+    unsigned char* const data_;
+
+    // Written by the producer. Positions are free-running byte counters,
+    // masked to find their place in the storage.
+    alignas(detail::cache_line_size) std::atomic<std::size_t> tail_{0};
+    std::size_t head_cache_{0};
+    std::size_t reserved_{0};
+    WaitStrategy not_empty_;
+
+    // Written by the consumer.
+    alignas(detail::cache_line_size) std::atomic<std::size_t> head_{0};
+    std::size_t tail_cache_{0};
+    std::size_t read_end_{0};
+    WaitStrategy not_full_;
+};
+
+} // namespace samwarring
+
+#endif
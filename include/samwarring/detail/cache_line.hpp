@@ -0,0 +1,74 @@
+#ifndef INCLUDED_SAMWARRING_DETAIL_CACHE_LINE_HPP
+#define INCLUDED_SAMWARRING_DETAIL_CACHE_LINE_HPP
+
+#include <cstddef>
+#include <new>
+
+namespace samwarring {
+namespace detail {
+
+/**
+ * @brief Alignment used to keep independently-written data on separate cache
+ * lines.
+ *
+ * `std::hardware_destructive_interference_size` would be the standard choice,
+ * but compilers warn when it is used in headers because its value may differ
+ * between translation units. A fixed value keeps the layout of shared types
+ * stable across the whole program.
+ */
+#if defined(__APPLE__) && defined(__aarch64__)
+inline constexpr std::size_t cache_line_size = 128;
+#else
+inline constexpr std::size_t cache_line_size = 64;
+#endif
+
+/**
+ * @brief Allocator whose blocks start on a cache line and fill whole cache
+ * lines.
+ *
+ * An array from the default allocator may share its first and last cache
+ * lines with neighbouring allocations. Arrays written by different threads
+ * then falsely share those lines, even when the objects that own them are
+ * cache-line aligned. Rounding each block out to whole lines rules this out.
+ */
+template <class T>
+struct cache_aligned_allocator {
+    using value_type = T;
+
+    cache_aligned_allocator() noexcept = default;
+
+    template <class U>
+    cache_aligned_allocator(const cache_aligned_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(
+            padded_size(n), std::align_val_t{cache_line_size}));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        ::operator delete(p, padded_size(n),
+                          std::align_val_t{cache_line_size});
+    }
+
+    template <class U>
+    bool operator==(const cache_aligned_allocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <class U>
+    bool operator!=(const cache_aligned_allocator<U>&) const noexcept {
+        return false;
+    }
+
+  private:
+    static std::size_t padded_size(std::size_t n) noexcept {
+        const std::size_t bytes = n * sizeof(T);
+        return (bytes + cache_line_size - 1) / cache_line_size *
+               cache_line_size;
+    }
+};
+
+} // namespace detail
+} // namespace samwarring
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef INCLUDED_SAMWARRING_DETAIL_FUTEX_HPP
+#define INCLUDED_SAMWARRING_DETAIL_FUTEX_HPP
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace samwarring {
+namespace detail {
+
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t) &&
+                  std::atomic<std::uint32_t>::is_always_lock_free,
+              "std::atomic<std::uint32_t> cannot be used as a futex word");
+
+/**
+ * @brief Sleeps until `word` is woken by futex_wake, as long as it still
+ * holds `expected`.
+ *
+ * Returns immediately if `word` does not hold `expected`. May also return
+ * spuriously, so callers re-check their condition in a loop.
+ *
+ * The futex is shared, so it works across processes when `word` lives in
+ * shared memory.
+ *
+ * @param timeout Relative timeout, or nullptr to wait indefinitely.
+ */
+inline void futex_wait(const std::atomic<std::uint32_t>& word,
+                       std::uint32_t expected,
+                       const struct timespec* timeout = nullptr) noexcept {
+    ::syscall(SYS_futex, &word, FUTEX_WAIT, expected, timeout, nullptr, 0);
+}
+
+/**
+ * @brief Wakes up to `count` waiters sleeping on `word`.
+ */
+inline void futex_wake(const std::atomic<std::uint32_t>& word,
+                       int count = INT_MAX) noexcept {
+    ::syscall(SYS_futex, &word, FUTEX_WAKE, count, nullptr, nullptr, 0);
+}
+
+/**
+ * @brief Like futex_wait, for a `word` only shared between threads of one
+ * process. The kernel can skip looking up the shared mapping.
+ */
+inline void
+futex_wait_private(const std::atomic<std::uint32_t>& word,
+                   std::uint32_t expected,
+                   const struct timespec* timeout = nullptr) noexcept {
+    ::syscall(SYS_futex, &word, FUTEX_WAIT_PRIVATE, expected, timeout, nullptr,
+              0);
+}
+
+/**
+ * @brief Like futex_wake, for a `word` only shared between threads of one
+ * process.
+ */
+inline void futex_wake_private(const std::atomic<std::uint32_t>& word,
+                               int count = INT_MAX) noexcept {
+    ::syscall(SYS_futex, &word, FUTEX_WAKE_PRIVATE, count, nullptr, nullptr,
+              0);
+}
+
+} // namespace detail
+} // namespace samwarring
+
+#endif
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef INCLUDED_SAMWARRING_DETAIL_POWER_OF_TWO_HPP
+#define INCLUDED_SAMWARRING_DETAIL_POWER_OF_TWO_HPP
+
+#include <cstddef>
+
+namespace samwarring {
+namespace detail {
+
+/**
+ * @brief Returns the smallest power of two that is at least `n` and at least
+ * `minimum`.
+ *
+ * `minimum` must itself be a power of two. The ring buffers use this to size
+ * their storage, so that positions wrap with a mask instead of a division.
+ */
+constexpr std::size_t
+round_up_to_power_of_two(std::size_t n, std::size_t minimum = 1) noexcept {
+    std::size_t p = minimum;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+} // namespace detail
+} // namespace samwarring
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef INCLUDED_SAMWARRING_DETAIL_THREAD_ORDINAL_HPP
+#define INCLUDED_SAMWARRING_DETAIL_THREAD_ORDINAL_HPP
+
+#include <atomic>
+#include <cstddef>
+
+namespace samwarring {
+namespace detail {
+
+/**
+ * @brief Returns a small number identifying the calling thread, assigned in
+ * the order threads first call this function.
+ *
+ * Sharded types map threads to shards with this number, so that the first
+ * threads to use them land in different shards.
+ */
+inline std::size_t this_thread_ordinal() noexcept {
+    static std::atomic<std::size_t> next{0};
+    thread_local const std::size_t ordinal =
+        next.fetch_add(1, std::memory_order_relaxed);
+    return ordinal;
+}
+
+} // namespace detail
+} // namespace samwarring
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef INCLUDED_SAMWARRING_MEMORY_RESOURCE_HPP
+#define INCLUDED_SAMWARRING_MEMORY_RESOURCE_HPP
+
+#if defined(__linux__)
+
+#include <cerrno>
+#include <cstddef>
+#include <fstream>
+#include <linux/mempolicy.h>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace samwarring {
+
+/**
+ * @brief Options for @ref mapped_memory_resource.
+ */
+struct mapped_memory_options {
+    /**
+     * Back allocations with huge pages. Explicit huge pages (MAP_HUGETLB) are
+     * tried first. If none are reserved, the allocation falls back to regular
+     * pages with transparent huge pages requested through madvise(2).
+     * Allocations are rounded up to a multiple of
+     * mapped_memory_resource::huge_page_size().
+     */
+    bool huge_pages = false;
+
+    /**
+     * Bind allocations to this NUMA node with mbind(2), or leave them under
+     * the thread's default policy if negative.
+     */
+    int numa_node = -1;
+
+    /**
+     * Fault in every page when it is allocated, instead of on first access.
+     * Under the default first-touch policy, this also places the pages on the
+     * NUMA node of the allocating thread.
+     */
+    bool populate = false;
+
+    /**
+     * Size of the explicit huge pages, such as 1 GiB. It must be a power of
+     * two that the kernel supports. If 0, the system's default huge page size
+     * is used.
+     */
+    std::size_t huge_page_size = 0;
+};
+
+/**
+ * A std::pmr::memory_resource that maps every allocation directly with
+ * mmap(2).
+ *
+ * This suits a few very large, long-lived allocations, like the storage of a
+ * big @ref pmr::ring_buffer, where huge pages cut TLB misses and NUMA
+ * placement keeps the memory next to the threads that use it. Each
+ * allocation costs a system call and occupies at least one page, so small
+ * allocations should come from a pool or arena resource instead. A
+ * mapped_memory_resource can be the upstream of such a resource.
+ *
+ * This class is only available on Linux.
+ *
+ * Example
+ * -------
+ *
+ *      mapped_memory_resource huge{{true, 0}};  // Huge pages on node 0
+ *      pmr::ring_buffer<sample> window{1 << 24, &huge};
+ */
+class mapped_memory_resource : public std::pmr::memory_resource {
+  public:
+    /**
+     * @brief Constructs a resource that maps allocations with `options`.
+     *
+     * @throws std::invalid_argument if `options.huge_page_size` is not 0 or a
+     * power of two.
+     */
+    explicit mapped_memory_resource(mapped_memory_options options = {})
+        : options_{options},
+          page_size_{static_cast<std::size_t>(::sysconf(_SC_PAGESIZE))},
+          huge_page_size_{options.huge_page_size
+                              ? check_huge_page_size(options.huge_page_size)
+                              : default_huge_page_size()} {}
+
+    mapped_memory_resource(const mapped_memory_resource&) = delete;
+    mapped_memory_resource& operator=(const mapped_memory_resource&) = delete;
+
+    const mapped_memory_options& options() const noexcept {
+        return options_;
+    }
+
+    /**
+     * @return Size of the huge pages used with mapped_memory_options::
+     * huge_pages.
+     */
+    std::size_t huge_page_size() const noexcept {
+        return huge_page_size_;
+    }
+
+    /**
+     * @brief Returns the system's default huge page size.
+     *
+     * It is read once from the Hugepagesize line of /proc/meminfo. It varies
+     * between systems, for example 2 MiB on x86-64 and 512 MiB on arm64 with
+     * 64 KiB pages. If it cannot be read, 2 MiB is assumed.
+     */
+    static std::size_t default_huge_page_size() {
+        static const std::size_t size = [] {
+            std::ifstream meminfo{"/proc/meminfo"};
+            std::string key;
+            std::size_t kib = 0;
+            while (meminfo >> key) {
+                if (key == "Hugepagesize:" && meminfo >> kib && kib) {
+                    return kib << 10;
+                }
+                meminfo.ignore(256, '\n');
+            }
+            return std::size_t{2} << 20;
+        }();
+        return size;
+    }
+
+  protected:
+    /**
+     * @throws std::bad_alloc if the memory cannot be mapped, or if
+     * `alignment` exceeds the page size.
+     * @throws std::system_error if the memory cannot be bound to the NUMA
+     * node.
+     */
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (alignment > page_size_) {
+            throw std::bad_alloc{};
+        }
+        const std::size_t length = mapping_length(bytes);
+        const int prot = PROT_READ | PROT_WRITE;
+        const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        void* addr = MAP_FAILED;
+        if (options_.huge_pages) {
+            addr = ::mmap(nullptr, length, prot, flags | huge_page_flags(),
+                          -1, 0);
+        }
+        if (addr == MAP_FAILED) {
+            addr = ::mmap(nullptr, length, prot, flags, -1, 0);
+            if (addr == MAP_FAILED) {
+                throw std::bad_alloc{};
+            }
+            if (options_.huge_pages) {
+                // Only a hint. Transparent huge pages may be disabled.
+                ::madvise(addr, length, MADV_HUGEPAGE);
+            }
+        }
+
+        if (options_.numa_node >= 0) {
+            try {
+                bind(addr, length);
+            } catch (...) {
+                ::munmap(addr, length);
+                throw;
+            }
+        }
+        if (options_.populate) {
+            auto* bytes_begin = static_cast<volatile unsigned char*>(addr);
+            for (std::size_t i = 0; i < length; i += page_size_) {
+                bytes_begin[i] = 0;
+            }
+        }
+        return addr;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes,
+                       std::size_t /*alignment*/) override {
+        ::munmap(p, mapping_length(bytes));
+    }
+
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+  private:
+    static std::size_t check_huge_page_size(std::size_t size) {
+        if ((size & (size - 1)) != 0) {
+            throw std::invalid_argument{
+                "huge_page_size must be a power of two"};
+        }
+        return size;
+    }
+
+    // MAP_HUGETLB, with the page size encoded if one was chosen explicitly.
+    int huge_page_flags() const noexcept {
+        int flags = MAP_HUGETLB;
+        if (options_.huge_page_size) {
+            int log2 = 0;
+            while ((std::size_t{1} << log2) < huge_page_size_) {
+                ++log2;
+            }
+            flags |= log2 << MAP_HUGE_SHIFT;
+        }
+        return flags;
+    }
+
+    std::size_t mapping_length(std::size_t bytes) const noexcept {
+        const std::size_t unit =
+            options_.huge_pages ? huge_page_size_ : page_size_;
+        const std::size_t n = bytes == 0 ? 1 : bytes;
+        return (n + unit - 1) / unit * unit;
+    }
+
+    void bind(void* addr, std::size_t length) const {
+        constexpr std::size_t max_nodes = 1024;
+        constexpr std::size_t bits_per_word = 8 * sizeof(unsigned long);
+        const auto node = static_cast<std::size_t>(options_.numa_node);
+        unsigned long mask[max_nodes / bits_per_word] = {};
+        if (node >= max_nodes) {
+            throw std::system_error{EINVAL, std::system_category(), "mbind"};
+        }
+        mask[node / bits_per_word] = 1UL << (node % bits_per_word);
+        // The kernel reads one bit fewer than `maxnode`.
+        if (::syscall(SYS_mbind, addr, length, MPOL_BIND, mask,
+                      static_cast<unsigned long>(max_nodes + 1), 0) != 0) {
+            throw std::system_error{errno, std::system_category(), "mbind"};
+        }
+    }
+
+    mapped_memory_options options_;
+    std::size_t page_size_;
+    std::size_t huge_page_size_;
+};
+
+} // namespace samwarring
+
+#endif
+
+#endif
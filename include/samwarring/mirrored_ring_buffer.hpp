@@ -0,0 +1,230 @@
+#ifndef INCLUDED_SAMWARRING_MIRRORED_RING_BUFFER_HPP
+#define INCLUDED_SAMWARRING_MIRRORED_RING_BUFFER_HPP
+
+#if defined(__linux__)
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+#include <sys/mman.h>
+#include <system_error>
+#include <type_traits>
+#include <unistd.h>
+
+namespace samwarring {
+
+/**
+ * Fixed-size buffer where each insertion overwrites the oldest element, and
+ * the whole window is always one contiguous span of memory.
+ *
+ * mirrored_ring_buffer behaves like @ref ring_buffer, but its storage is
+ * mapped into virtual memory twice, back-to-back. A write to slot `i` is also
+ * visible at slot `i + capacity()`. As a result, the items from front to back
+ * are always laid out contiguously from data() to data() + capacity(), even
+ * after the buffer wraps around. The window can be handed directly to SIMD
+ * routines, `write(2)`, or any function taking a pointer and a length,
+ * without stitching together @ref ring_buffer::first_part and
+ * @ref ring_buffer::second_part.
+ *
+ * The storage is a memfd_create(2) file mapped with mmap(2), so this class is
+ * only available on Linux. The size of the mapping must be a multiple of the
+ * page size, so the capacity is rounded up until `capacity() * sizeof(T)` is
+ * a whole number of pages. All items start out zero-filled.
+ *
+ * Example
+ * -------
+ *
+ *      mirrored_ring_buffer<char> buf{4096};
+ *      buf.push_back(data, n);
+ *      write(fd, buf.data(), buf.capacity());  // Oldest to newest
+ *
+ * @tparam T Element type. Must be trivially copyable, since items are
+ * created by zero-filled pages and copied with memcpy.
+ */
+template <class T>
+class mirrored_ring_buffer {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Item type is not trivially copyable");
+
+  public:
+    /**
+     * @brief Maps a new buffer.
+     *
+     * @param capacity Minimum number of items in the buffer. It is rounded up
+     * so that the buffer occupies a whole number of pages.
+     * @throws std::system_error if the memory cannot be mapped.
+     */
+    explicit mirrored_ring_buffer(std::size_t capacity)
+        : capacity_{round_up_to_pages(capacity)} {
+        const std::size_t bytes = capacity_ * sizeof(T);
+        int fd = ::memfd_create("samwarring_mirrored_ring_buffer", MFD_CLOEXEC);
+        if (fd == -1) {
+            throw_system_error("memfd_create");
+        }
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) == -1) {
+            int err = errno;
+            ::close(fd);
+            throw_system_error("ftruncate", err);
+        }
+
+        // Reserve enough address space for both copies, then map the file
+        // over each half of the reservation.
+        void* base = ::mmap(nullptr, 2 * bytes, PROT_NONE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            int err = errno;
+            ::close(fd);
+            throw_system_error("mmap", err);
+        }
+        auto* first = static_cast<unsigned char*>(base);
+        for (unsigned char* half : {first, first + bytes}) {
+            if (::mmap(half, bytes, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+                int err = errno;
+                ::munmap(base, 2 * bytes);
+                ::close(fd);
+                throw_system_error("mmap", err);
+            }
+        }
+        ::close(fd);
+        data_ = static_cast<T*>(base);
+    }
+
+    mirrored_ring_buffer(const mirrored_ring_buffer&) = delete;
+    mirrored_ring_buffer& operator=(const mirrored_ring_buffer&) = delete;
+
+    /**
+     * @brief Takes ownership of another buffer's mapping.
+     *
+     * The moved-from buffer has no mapping and no capacity.
+     */
+    mirrored_ring_buffer(mirrored_ring_buffer&& other) noexcept
+        : data_{other.data_}, capacity_{other.capacity_}, next_{other.next_} {
+        other.data_ = nullptr;
+        other.capacity_ = 0;
+        other.next_ = 0;
+    }
+
+    /**
+     * @brief Unmaps the buffer.
+     */
+    ~mirrored_ring_buffer() {
+        if (data_) {
+            ::munmap(data_, 2 * capacity_ * sizeof(T));
+        }
+    }
+
+    std::size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    void push_back(const T& item) noexcept {
+        data_[next_] = item;
+        next_ = wrap(next_ + 1);
+    }
+
+    /**
+     * Pushes `count` items from contiguous memory with a single memcpy.
+     *
+     * If `count` exceeds the capacity, only the last `capacity()` items are
+     * written.
+     *
+     * @param items Pointer to the first item.
+     * @param count Number of items.
+     */
+    void push_back(const T* items, std::size_t count) noexcept {
+        if (count >= capacity_) {
+            std::memcpy(data_, items + (count - capacity_),
+                        capacity_ * sizeof(T));
+            next_ = 0;
+            return;
+        }
+        // The write may run past the end of the first mapping into the
+        // second, which lands it at the start of the storage.
+        if (count) {
+            std::memcpy(data_ + next_, items, count * sizeof(T));
+        }
+        next_ = wrap(next_ + count);
+    }
+
+    /**
+     * @return Pointer to the front item. The following `capacity()` items are
+     * the whole window, from front to back.
+     */
+    T* data() noexcept {
+        return data_ + next_;
+    }
+
+    const T* data() const noexcept {
+        return data_ + next_;
+    }
+
+    T* begin() noexcept {
+        return data();
+    }
+
+    const T* begin() const noexcept {
+        return data();
+    }
+
+    T* end() noexcept {
+        return data() + capacity_;
+    }
+
+    const T* end() const noexcept {
+        return data() + capacity_;
+    }
+
+    T& operator[](std::size_t index) noexcept {
+        return data()[index];
+    }
+
+    const T& operator[](std::size_t index) const noexcept {
+        return data()[index];
+    }
+
+    T& front() noexcept {
+        return data()[0];
+    }
+
+    const T& front() const noexcept {
+        return data()[0];
+    }
+
+    T& back() noexcept {
+        return data()[capacity_ - 1];
+    }
+
+    const T& back() const noexcept {
+        return data()[capacity_ - 1];
+    }
+
+  private:
+    std::size_t wrap(std::size_t index) const noexcept {
+        return index >= capacity_ ? index - capacity_ : index;
+    }
+
+    // Smallest multiple of the items-per-page granule that is >= capacity.
+    static std::size_t round_up_to_pages(std::size_t capacity) {
+        const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        const std::size_t granule = page / std::gcd(page, sizeof(T));
+        const std::size_t n = capacity == 0 ? 1 : capacity;
+        return (n + granule - 1) / granule * granule;
+    }
+
+    [[noreturn]] static void throw_system_error(const char* what,
+                                                int err = errno) {
+        throw std::system_error{err, std::system_category(), what};
+    }
+
+    T* data_;
+    std::size_t capacity_;
+    std::size_t next_{0};
+};
+
+} // namespace samwarring
+
+#endif
+
+#endif
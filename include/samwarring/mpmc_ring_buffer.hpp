@@ -0,0 +1,348 @@
+#ifndef INCLUDED_SAMWARRING_MPMC_RING_BUFFER_HPP
+#define INCLUDED_SAMWARRING_MPMC_RING_BUFFER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <samwarring/detail/cache_line.hpp>
+#include <samwarring/detail/power_of_two.hpp>
+#include <samwarring/wait_strategy.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace samwarring {
+
+/**
+ * @brief Lock-free bounded queue for any number of producer and consumer
+ * threads.
+ *
+ * This is Dmitry Vyukov's bounded MPMC queue. Every slot carries a sequence
+ * number that tells producers and consumers whether the slot is ready for
+ * them:
+ *
+ * - A producer that claimed position `pos` may write to the slot once its
+ *   sequence equals `pos`. After writing, it publishes the item by setting
+ *   the sequence to `pos + 1`.
+ * - A consumer that claimed position `pos` may read from the slot once its
+ *   sequence equals `pos + 1`. After reading, it frees the slot for the next
+ *   lap by setting the sequence to `pos + capacity`.
+ *
+ * Claiming a position is a single compare-and-swap on the enqueue or dequeue
+ * counter, which live on separate cache lines. Producers only contend with
+ * producers, and consumers only contend with consumers.
+ *
+ * Like @ref spsc_ring_buffer, a full queue rejects new items instead of
+ * overwriting the oldest one. The capacity is rounded up to a power of two so
+ * that positions map to slots with a mask.
+ *
+ * The blocking functions (push, emplace, pop and the timed try_*_until
+ * forms) wait for room or for an item with `WaitStrategy`, as in
+ * @ref spsc_ring_buffer. Any number of threads may wait at once.
+ *
+ * Example
+ * -------
+ *
+ *      mpmc_ring_buffer<int> queue{1024};
+ *
+ *      // Any producer thread
+ *      queue.try_push(sample);
+ *
+ *      // Any consumer thread
+ *      int sample;
+ *      if (queue.try_pop(sample)) {
+ *          process(sample);
+ *      }
+ *
+ * @tparam T Element type. Must be nothrow-move-constructable, because an item
+ * cannot be abandoned half-way through a claimed slot.
+ * @tparam WaitStrategy How the blocking functions wait.
+ */
+template <class T, class WaitStrategy = busy_spin>
+class alignas(detail::cache_line_size) mpmc_ring_buffer {
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+                  "Item type is not nothrow-move-constructable");
+
+  public:
+    /**
+     * @brief Constructs an empty queue.
+     *
+     * @param capacity Minimum number of items the queue can hold. It is
+     * rounded up to the next power of two, and to at least 2. With a single
+     * slot, the sequence number of a full slot would equal that of a free
+     * slot on the next lap.
+     */
+    explicit mpmc_ring_buffer(std::size_t capacity)
+        : mask_{detail::round_up_to_power_of_two(capacity, 2) - 1},
+          slots_{std::allocator<slot>{}.allocate(mask_ + 1)} {
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            ::new (static_cast<void*>(slots_ + i)) slot{};
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpmc_ring_buffer(const mpmc_ring_buffer&) = delete;
+    mpmc_ring_buffer(mpmc_ring_buffer&&) = delete;
+    mpmc_ring_buffer& operator=(const mpmc_ring_buffer&) = delete;
+    mpmc_ring_buffer& operator=(mpmc_ring_buffer&&) = delete;
+
+    /**
+     * @brief Destroys all items remaining in the queue, and releases memory.
+     *
+     * No other thread may be using the queue.
+     */
+    ~mpmc_ring_buffer() {
+        std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        std::size_t end = enqueue_pos_.load(std::memory_order_relaxed);
+        for (; pos != end; ++pos) {
+            slots_[pos & mask_].item()->~T();
+        }
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            slots_[i].~slot();
+        }
+        std::allocator<slot>{}.deallocate(slots_, mask_ + 1);
+    }
+
+    /**
+     * @return Maximum number of items the queue can hold.
+     */
+    std::size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    /**
+     * @brief Returns the approximate number of items in the queue.
+     *
+     * The result includes items whose producers or consumers have claimed a
+     * slot but not yet finished with it.
+     */
+    std::size_t size() const noexcept {
+        std::size_t dequeued = dequeue_pos_.load(std::memory_order_acquire);
+        std::size_t enqueued = enqueue_pos_.load(std::memory_order_acquire);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    /**
+     * @brief Constructs an item at the back of the queue.
+     *
+     * If constructing T from `args` may throw, the item is constructed before
+     * a slot is claimed and then moved into the slot.
+     *
+     * @return true if the item was pushed, or false if the queue was full.
+     */
+    template <class... Args>
+    bool try_emplace(Args&&... args) {
+        if constexpr (std::is_nothrow_constructible_v<T, Args&&...>) {
+            return emplace_claimed(std::forward<Args>(args)...);
+        } else {
+            T item(std::forward<Args>(args)...);
+            return emplace_claimed(std::move(item));
+        }
+    }
+
+    /**
+     * @brief Copies an item to the back of the queue.
+     *
+     * @return true if the item was pushed, or false if the queue was full.
+     */
+    bool try_push(const T& item) {
+        return try_emplace(item);
+    }
+
+    /**
+     * @brief Moves an item to the back of the queue.
+     *
+     * @return true if the item was pushed, or false if the queue was full. If
+     * the queue was full, `item` is not moved-from.
+     */
+    bool try_push(T&& item) noexcept {
+        return emplace_claimed(std::move(item));
+    }
+
+    /**
+     * @brief Moves the item at the front of the queue into `item`.
+     *
+     * @param item Receives the oldest item by move-assignment.
+     * @return true if an item was popped, or false if the queue was empty.
+     */
+    bool try_pop(T& item) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        slot* s;
+        for (;;) {
+            s = &slots_[pos & mask_];
+            std::size_t seq = s->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        T* claimed = s->item();
+        item = std::move(*claimed);
+        claimed->~T();
+        s->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        not_full_.notify();
+        return true;
+    }
+
+    /**
+     * @brief Constructs an item at the back of the queue, waiting while the
+     * queue is full.
+     */
+    template <class... Args>
+    void emplace(Args&&... args) {
+        // emplace_claimed only uses its arguments once it has claimed a
+        // slot, so they can be forwarded again after a failed attempt.
+        if constexpr (std::is_nothrow_constructible_v<T, Args&&...>) {
+            while (!emplace_claimed(std::forward<Args>(args)...)) {
+                not_full_.wait([this] { return !looks_full(); });
+            }
+        } else {
+            T item(std::forward<Args>(args)...);
+            while (!emplace_claimed(std::move(item))) {
+                not_full_.wait([this] { return !looks_full(); });
+            }
+        }
+    }
+
+    /**
+     * @brief Copies an item to the back of the queue, waiting while the queue
+     * is full.
+     */
+    void push(const T& item) {
+        emplace(item);
+    }
+
+    /**
+     * @brief Moves an item to the back of the queue, waiting while the queue
+     * is full.
+     */
+    void push(T&& item) noexcept {
+        emplace(std::move(item));
+    }
+
+    /**
+     * @brief Moves an item to the back of the queue, waiting until `deadline`
+     * while the queue is full.
+     *
+     * @return true if the item was pushed, or false if the queue was still
+     * full at the deadline. In that case, `item` is not moved-from.
+     */
+    template <class Clock, class Duration>
+    bool try_push_until(
+        T&& item, const std::chrono::time_point<Clock, Duration>& deadline) {
+        while (!emplace_claimed(std::move(item))) {
+            if (!not_full_.wait_until([this] { return !looks_full(); },
+                                      deadline)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Moves the item at the front of the queue into `item`, waiting
+     * while the queue is empty.
+     */
+    void pop(T& item) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        while (!try_pop(item)) {
+            not_empty_.wait([this] { return !looks_empty(); });
+        }
+    }
+
+    /**
+     * @brief Moves the item at the front of the queue into `item`, waiting
+     * until `deadline` while the queue is empty.
+     *
+     * @return true if an item was popped, or false if the queue was still
+     * empty at the deadline.
+     */
+    template <class Clock, class Duration>
+    bool
+    try_pop_until(T& item,
+                  const std::chrono::time_point<Clock, Duration>& deadline) {
+        while (!try_pop(item)) {
+            if (!not_empty_.wait_until([this] { return !looks_empty(); },
+                                       deadline)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+  private:
+    struct slot {
+        std::atomic<std::size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* item() noexcept {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+
+    template <class... Args>
+    bool emplace_claimed(Args&&... args) noexcept {
+        std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        slot* s;
+        for (;;) {
+            s = &slots_[pos & mask_];
+            std::size_t seq = s->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        ::new (static_cast<void*>(s->storage)) T(std::forward<Args>(args)...);
+        s->sequence.store(pos + 1, std::memory_order_release);
+        not_empty_.notify();
+        return true;
+    }
+
+    // True if the next producer would find its slot still occupied.
+    bool looks_full() const noexcept {
+        const std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        const std::size_t seq =
+            slots_[pos & mask_].sequence.load(std::memory_order_acquire);
+        return static_cast<std::ptrdiff_t>(seq - pos) < 0;
+    }
+
+    // True if the next consumer would find its slot not yet written.
+    bool looks_empty() const noexcept {
+        const std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        const std::size_t seq =
+            slots_[pos & mask_].sequence.load(std::memory_order_acquire);
+        return static_cast<std::ptrdiff_t>(seq - (pos + 1)) < 0;
+    }
+
+    // Read-only after construction.
+    const std::size_t mask_;
+    slot* const slots_;
+
+    // Contended by producers. Consumers only write to not_empty_ when they
+    // are about to sleep.
+    alignas(detail::cache_line_size) std::atomic<std::size_t> enqueue_pos_{0};
+    WaitStrategy not_empty_;
+
+    // Contended by consumers. Producers only write to not_full_ when they are
+    // about to sleep.
+    alignas(detail::cache_line_size) std::atomic<std::size_t> dequeue_pos_{0};
+    WaitStrategy not_full_;
+};
+
+} // namespace samwarring
+
+#endif
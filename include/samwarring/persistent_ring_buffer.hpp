@@ -0,0 +1,400 @@
+#ifndef INCLUDED_SAMWARRING_PERSISTENT_RING_BUFFER_HPP
+#define INCLUDED_SAMWARRING_PERSISTENT_RING_BUFFER_HPP
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <type_traits>
+#include <unistd.h>
+
+namespace samwarring {
+
+namespace detail {
+
+/**
+ * @brief Header at the start of a @ref persistent_ring_buffer file.
+ */
+struct persistent_ring_header {
+    std::uint64_t magic;
+    std::uint64_t item_size;
+    std::uint64_t capacity;
+    std::uint64_t next;
+    std::uint64_t size;
+    std::uint64_t generation; // Odd while a push is in progress.
+};
+
+} // namespace detail
+
+/**
+ * Fixed-size buffer where each insertion overwrites the oldest element, kept
+ * in a memory-mapped file so that it survives the process.
+ *
+ * persistent_ring_buffer behaves like @ref ring_buffer, but its header and
+ * slots live in a file mapped with mmap(2) as MAP_SHARED. Every push writes
+ * straight into the page cache, so when the process crashes, the kernel still
+ * holds the last `capacity()` items. Opening the file again maps the same
+ * pages and recovers the window in place, without reading or copying it.
+ *
+ * A push is a handful of plain stores: the item into its slot, plus the
+ * header's position, size and generation. The generation is made odd before
+ * the slot is written and even again once the header is consistent. If the
+ * process dies in between, the next open sees an odd generation. It rebuilds
+ * the position and size from the generation, and drops the slot that was
+ * being written, since it may hold a mix of the old and new item.
+ *
+ * The file outlives a crash of the process, but not a crash of the kernel or
+ * a power loss, unless sync() has been called since the last push.
+ *
+ * The header records the magic number, the item size and the capacity.
+ * Opening a file whose header does not match throws rather than
+ * reinterpreting its contents.
+ *
+ * This class is only available on Linux.
+ *
+ * Example
+ * -------
+ *
+ *      persistent_ring_buffer<event> events{"/var/tmp/events.ring", 4096};
+ *      for (const event& e : events) {
+ *          report(e);  // Left over from a previous run.
+ *      }
+ *      events.push_back(e);
+ *
+ * @tparam T Element type. Must be trivially copyable, since items are stored
+ * as raw bytes in the file.
+ */
+template <class T>
+class persistent_ring_buffer {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Item type is not trivially copyable");
+
+  public:
+    /**
+     * @brief Identifies the file format: "SWRING01".
+     */
+    static constexpr std::uint64_t magic = 0x3130474e49525753;
+
+    /**
+     * @brief Opens or creates a buffer backed by a file.
+     *
+     * If the file is missing or empty, it is created and sized for `capacity`
+     * items, and the buffer starts empty. Otherwise, the window left in the
+     * file is recovered.
+     *
+     * @param path Path of the backing file.
+     * @param capacity Number of items in the buffer. Must be non-zero.
+     * @throws std::invalid_argument if `capacity` is zero.
+     * @throws std::system_error if the file cannot be opened or mapped.
+     * @throws std::runtime_error if the file was written with another item
+     * size or capacity, or is not a persistent_ring_buffer file.
+     */
+    persistent_ring_buffer(const std::string& path, std::size_t capacity)
+        : capacity_{capacity} {
+        if (capacity == 0) {
+            throw std::invalid_argument{"capacity must be non-zero"};
+        }
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd == -1) {
+            throw_system_error("open");
+        }
+        struct stat st;
+        if (::fstat(fd, &st) == -1) {
+            int err = errno;
+            ::close(fd);
+            throw_system_error("fstat", err);
+        }
+        const bool create = st.st_size == 0;
+        if (create && ::ftruncate(fd, static_cast<off_t>(file_size())) == -1) {
+            int err = errno;
+            ::close(fd);
+            throw_system_error("ftruncate", err);
+        }
+        if (!create && static_cast<std::size_t>(st.st_size) != file_size()) {
+            ::close(fd);
+            throw std::runtime_error{path + ": size does not match capacity"};
+        }
+        void* base = ::mmap(nullptr, file_size(), PROT_READ | PROT_WRITE,
+                            MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            int err = errno;
+            ::close(fd);
+            throw_system_error("mmap", err);
+        }
+        ::close(fd);
+        header_ = static_cast<detail::persistent_ring_header*>(base);
+        data_ = reinterpret_cast<T*>(static_cast<unsigned char*>(base) +
+                                     slots_offset());
+        if (create) {
+            initialize();
+        } else {
+            try {
+                recover(path);
+            } catch (...) {
+                ::munmap(base, file_size());
+                throw;
+            }
+        }
+    }
+
+    persistent_ring_buffer(const persistent_ring_buffer&) = delete;
+    persistent_ring_buffer& operator=(const persistent_ring_buffer&) = delete;
+
+    /**
+     * @brief Takes ownership of another buffer's mapping.
+     *
+     * The moved-from buffer has no mapping and no capacity.
+     */
+    persistent_ring_buffer(persistent_ring_buffer&& other) noexcept
+        : header_{other.header_}, data_{other.data_},
+          capacity_{other.capacity_}, next_{other.next_}, size_{other.size_},
+          generation_{other.generation_} {
+        other.header_ = nullptr;
+        other.data_ = nullptr;
+        other.capacity_ = 0;
+        other.next_ = 0;
+        other.size_ = 0;
+    }
+
+    /**
+     * @brief Unmaps the file. Its contents are left for the next open.
+     */
+    ~persistent_ring_buffer() {
+        if (header_) {
+            ::munmap(header_, file_size());
+        }
+    }
+
+    std::size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    /**
+     * @return Number of live items in the buffer, up to capacity().
+     */
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    bool full() const noexcept {
+        return size_ == capacity_;
+    }
+
+    /**
+     * @return Twice the number of pushes committed to the file since it was
+     * created or last cleared.
+     */
+    std::uint64_t generation() const noexcept {
+        return generation_;
+    }
+
+    void push_back(const T& item) noexcept {
+        // Compiler fences keep the stores in program order. The CPU may
+        // reorder them, but a crashed process's stores still reach the page
+        // cache, so only the order seen by the compiler matters.
+        header_->generation = generation_ + 1;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        data_[next_] = item;
+        next_ = next_ + 1 == capacity_ ? 0 : next_ + 1;
+        size_ += size_ != capacity_;
+        header_->next = next_;
+        header_->size = size_;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        generation_ += 2;
+        header_->generation = generation_;
+    }
+
+    /**
+     * @brief Drops all items. The file keeps its capacity.
+     */
+    void clear() noexcept {
+        header_->generation = generation_ + 1;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        next_ = 0;
+        size_ = 0;
+        header_->next = 0;
+        header_->size = 0;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        generation_ = 0;
+        header_->generation = 0;
+    }
+
+    /**
+     * @brief Writes the file back to storage with msync(2), so that the
+     * window also survives a crash of the system.
+     *
+     * @throws std::system_error if msync fails.
+     */
+    void sync() const {
+        if (::msync(header_, file_size(), MS_SYNC) == -1) {
+            throw_system_error("msync");
+        }
+    }
+
+    const T& operator[](std::size_t index) const noexcept {
+        return data_[wrap(front_index() + index)];
+    }
+
+    const T& front() const noexcept {
+        return data_[front_index()];
+    }
+
+    const T& back() const noexcept {
+        return data_[next_ == 0 ? capacity_ - 1 : next_ - 1];
+    }
+
+    /**
+     * Forward iterator over items from front to back.
+     */
+    class const_iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = T;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const T& operator*() const noexcept {
+            return (*buf_)[offset_];
+        }
+
+        const T* operator->() const noexcept {
+            return &**this;
+        }
+
+        bool operator==(const const_iterator& other) const noexcept {
+            return offset_ == other.offset_;
+        }
+
+        bool operator!=(const const_iterator& other) const noexcept {
+            return offset_ != other.offset_;
+        }
+
+        const_iterator& operator++() noexcept {
+            ++offset_;
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++offset_;
+            return tmp;
+        }
+
+      private:
+        friend class persistent_ring_buffer;
+
+        const_iterator(const persistent_ring_buffer* buf,
+                       std::size_t offset) noexcept
+            : buf_{buf}, offset_{offset} {}
+
+        const persistent_ring_buffer* buf_;
+        std::size_t offset_;
+    };
+
+    const_iterator begin() const noexcept {
+        return const_iterator{this, 0};
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator{this, size_};
+    }
+
+  private:
+    std::size_t front_index() const noexcept {
+        return wrap(next_ + capacity_ - size_);
+    }
+
+    std::size_t wrap(std::size_t index) const noexcept {
+        return index >= capacity_ ? index - capacity_ : index;
+    }
+
+    // Slots start on their own cache line, after the header.
+    static constexpr std::size_t slots_offset() noexcept {
+        constexpr std::size_t align = alignof(T) > 64 ? alignof(T) : 64;
+        return (sizeof(detail::persistent_ring_header) + align - 1) / align *
+               align;
+    }
+
+    std::size_t file_size() const noexcept {
+        return slots_offset() + capacity_ * sizeof(T);
+    }
+
+    void initialize() noexcept {
+        header_->item_size = sizeof(T);
+        header_->capacity = capacity_;
+        header_->next = 0;
+        header_->size = 0;
+        header_->generation = 0;
+        // The magic number goes last, so a file left half-initialized is
+        // rejected rather than recovered.
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        header_->magic = magic;
+    }
+
+    void recover(const std::string& path) {
+        if (header_->magic != magic) {
+            throw std::runtime_error{path +
+                                     ": not a persistent_ring_buffer file"};
+        }
+        if (header_->item_size != sizeof(T) ||
+            header_->capacity != capacity_) {
+            throw std::runtime_error{path +
+                                     ": item size or capacity does not match"};
+        }
+        generation_ = header_->generation;
+        if (generation_ % 2 == 0) {
+            next_ = header_->next;
+            size_ = header_->size;
+            if (next_ < capacity_ && size_ <= capacity_) {
+                return;
+            }
+        }
+
+        // A push was interrupted, or the header is inconsistent. Every
+        // committed push added two to the generation, which is enough to
+        // rebuild the position and size. The slot at the rebuilt position
+        // may be torn. It is either unused, or it held the oldest item,
+        // which is dropped.
+        const std::uint64_t pushes = generation_ / 2;
+        next_ = static_cast<std::size_t>(pushes % capacity_);
+        size_ = pushes < capacity_ ? static_cast<std::size_t>(pushes)
+                                   : capacity_ - 1;
+        generation_ = pushes * 2;
+        header_->next = next_;
+        header_->size = size_;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        header_->generation = generation_;
+    }
+
+    [[noreturn]] static void throw_system_error(const char* what,
+                                                int err = errno) {
+        throw std::system_error{err, std::system_category(), what};
+    }
+
+    detail::persistent_ring_header* header_{nullptr};
+    T* data_{nullptr};
+    std::size_t capacity_;
+    std::size_t next_{0};
+    std::size_t size_{0};
+    std::uint64_t generation_{0};
+};
+
+} // namespace samwarring
+
+#endif
+
+#endif
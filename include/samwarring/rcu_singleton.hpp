@@ -0,0 +1,313 @@
+#ifndef INCLUDED_SAMWARRING_RCU_SINGLETON_HPP
+#define INCLUDED_SAMWARRING_RCU_SINGLETON_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <samwarring/detail/cache_line.hpp>
+#include <samwarring/singleton.hpp>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace samwarring {
+
+/**
+ * @brief Singleton whose object can be replaced at runtime, while readers
+ * keep using the version they started with.
+ *
+ * Configuration and routing tables are read on every request but replaced
+ * only now and then. Taking a lock to read them, or copying a
+ * std::shared_ptr, makes every reader write to memory shared with every
+ * other reader. An rcu_singleton (read-copy-update) lets readers use the
+ * current version without either:
+ *
+ * - A reader holds a @ref read_guard while it uses the object. Entering and
+ *   leaving a guard writes only to a slot owned by the calling thread, and
+ *   never waits. The one exception is a thread's first guard, which
+ *   registers the slot under a mutex of its own. Writers hold that mutex
+ *   only while they scan the slots, never while they copy the object or run
+ *   an update.
+ * - A writer builds a new version and publishes it with publish(), emplace()
+ *   or update(). Readers that start after that see the new version. Readers
+ *   that started before keep the old one until their guard is destroyed.
+ * - The old version is retired, and deleted once no reader can still be
+ *   using it.
+ *
+ * Old versions are reclaimed by epoch. Publishing advances a global epoch
+ * and tags the old version with the new epoch. A reader records the epoch it
+ * saw when its outermost guard is created, and clears it when that guard is
+ * destroyed. A retired version is deleted once every thread inside a guard
+ * has recorded at least its tag, since those threads loaded the object after
+ * it was replaced. Writers reclaim what they can each time they publish, and
+ * synchronize() waits until everything retired has been deleted.
+ *
+ * Before the first publish, the object is default-constructed on first use.
+ * Writers are serialized by a mutex, and may run on any thread. Guards may
+ * be nested, and must be destroyed on the thread that created them. A thread
+ * inside a guard must not call synchronize(), because it would wait for
+ * itself.
+ *
+ * Example
+ * -------
+ *
+ *      // On every request
+ *      auto cfg = rcu_singleton<config>::read();
+ *      route(request, cfg->routes);
+ *
+ *      // On reload
+ *      rcu_singleton<config>::publish(load_config(path));
+ *
+ * @tparam T The type of singleton object. Must be default-constructable.
+ * @tparam Tag Distinguishes between different singletons of the same type.
+ */
+template <class T, class Tag = default_singleton_tag>
+class rcu_singleton {
+    static_assert(std::is_default_constructible_v<T>,
+                  "Singleton type is not default constructable");
+
+    struct thread_slot;
+
+  public:
+    rcu_singleton() = delete;
+
+    /**
+     * @brief Read access to the version that was current when the guard was
+     * created. It stays alive until the guard is destroyed.
+     */
+    class read_guard {
+      public:
+        read_guard() : slot_{&thread_slot::local()} {
+            shared_state& s = state();
+            if (slot_->depth++ == 0) {
+                slot_->record->epoch.store(s.epoch.load());
+            }
+            ptr_ = s.current.load();
+        }
+
+        read_guard(const read_guard&) = delete;
+        read_guard& operator=(const read_guard&) = delete;
+
+        ~read_guard() {
+            if (--slot_->depth == 0) {
+                slot_->record->epoch.store(0, std::memory_order_release);
+            }
+        }
+
+        const T& operator*() const noexcept {
+            return *ptr_;
+        }
+
+        const T* operator->() const noexcept {
+            return ptr_;
+        }
+
+        const T* get() const noexcept {
+            return ptr_;
+        }
+
+      private:
+        thread_slot* slot_;
+        const T* ptr_;
+    };
+
+    /**
+     * @return A guard on the current version.
+     */
+    static read_guard read() {
+        return read_guard{};
+    }
+
+    /**
+     * @brief Replaces the object with `next`, and retires the previous
+     * version.
+     *
+     * Versions that no reader can still be using are deleted on the calling
+     * thread, after the writer mutex is released.
+     *
+     * @param next The new version. Must not be null.
+     */
+    static void publish(std::unique_ptr<T> next) {
+        shared_state& s = state();
+        std::vector<std::unique_ptr<T>> reclaimed;
+        {
+            std::lock_guard<std::mutex> lk{s.mtx};
+            publish_locked(s, std::move(next));
+            reclaimed = collect_locked(s);
+        }
+    }
+
+    /**
+     * @brief Constructs a new version from `args`, and publishes it.
+     */
+    template <class... Args>
+    static void emplace(Args&&... args) {
+        publish(std::make_unique<T>(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief Copies the current version, calls `fn(T&)` on the copy, and
+     * publishes it.
+     *
+     * Writers are serialized, so no other publish can land between the copy
+     * and the publish, and concurrent updates are never lost.
+     */
+    template <class Fn>
+    static void update(Fn fn) {
+        shared_state& s = state();
+        std::vector<std::unique_ptr<T>> reclaimed;
+        {
+            std::lock_guard<std::mutex> lk{s.mtx};
+            auto next = std::make_unique<T>(
+                *s.current.load(std::memory_order_relaxed));
+            fn(*next);
+            publish_locked(s, std::move(next));
+            reclaimed = collect_locked(s);
+        }
+    }
+
+    /**
+     * @brief Waits until every retired version has been deleted, which is
+     * once every reader that started before the last publish has finished.
+     */
+    static void synchronize() {
+        shared_state& s = state();
+        for (;;) {
+            std::vector<std::unique_ptr<T>> reclaimed;
+            std::unique_lock<std::mutex> lk{s.mtx};
+            reclaimed = collect_locked(s);
+            if (s.retired.empty()) {
+                return;
+            }
+            lk.unlock();
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @return Number of retired versions not yet deleted.
+     */
+    static std::size_t retired_count() {
+        shared_state& s = state();
+        std::lock_guard<std::mutex> lk{s.mtx};
+        return s.retired.size();
+    }
+
+  private:
+    // A reading thread's epoch, or 0 while the thread is outside any guard.
+    struct alignas(detail::cache_line_size) reader_record {
+        std::atomic<std::uint64_t> epoch{0};
+        bool in_use{false};
+    };
+
+    struct retired_version {
+        std::uint64_t epoch;
+        std::unique_ptr<T> object;
+    };
+
+    struct shared_state {
+        shared_state() : current{new T{}} {}
+
+        ~shared_state() {
+            delete current.load(std::memory_order_relaxed);
+        }
+
+        // Read by every reader, written only by publish.
+        std::atomic<T*> current;
+        std::atomic<std::uint64_t> epoch{1};
+
+        // Serializes writers. Only used under the mutex.
+        alignas(detail::cache_line_size) std::mutex mtx;
+        std::vector<retired_version> retired;
+
+        // Guards the list of records, separately from the writer mutex, so
+        // that a thread registering its first guard never waits for a
+        // writer's update function.
+        std::mutex records_mtx;
+        std::vector<std::unique_ptr<reader_record>> records;
+    };
+
+    // The calling thread's reader record, held until the thread exits and
+    // then left for another thread to reuse.
+    struct thread_slot {
+        static thread_slot& local() {
+            thread_local thread_slot slot{state()};
+            return slot;
+        }
+
+        explicit thread_slot(shared_state& s) {
+            std::lock_guard<std::mutex> lk{s.records_mtx};
+            for (auto& r : s.records) {
+                if (!r->in_use) {
+                    record = r.get();
+                    break;
+                }
+            }
+            if (!record) {
+                s.records.push_back(std::make_unique<reader_record>());
+                record = s.records.back().get();
+            }
+            record->in_use = true;
+        }
+
+        thread_slot(const thread_slot&) = delete;
+        thread_slot& operator=(const thread_slot&) = delete;
+
+        ~thread_slot() {
+            shared_state& s = state();
+            std::lock_guard<std::mutex> lk{s.records_mtx};
+            record->in_use = false;
+        }
+
+        reader_record* record{nullptr};
+        std::size_t depth{0};
+    };
+
+    static shared_state& state() {
+        static shared_state s;
+        return s;
+    }
+
+    static void publish_locked(shared_state& s, std::unique_ptr<T> next) {
+        s.retired.reserve(s.retired.size() + 1);
+        // The exchange comes before the epoch is advanced, so a reader that
+        // records the new epoch is sure to load the new version.
+        std::unique_ptr<T> previous{s.current.exchange(next.release())};
+        const std::uint64_t epoch = s.epoch.fetch_add(1) + 1;
+        s.retired.push_back(retired_version{epoch, std::move(previous)});
+    }
+
+    // Removes the retired versions that no reader can still be using, to be
+    // deleted by the caller once the writer mutex is released. Takes the
+    // records mutex while it scans the readers' epochs.
+    static std::vector<std::unique_ptr<T>> collect_locked(shared_state& s) {
+        std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+        {
+            std::lock_guard<std::mutex> lk{s.records_mtx};
+            for (const auto& r : s.records) {
+                const std::uint64_t epoch = r->epoch.load();
+                if (epoch != 0) {
+                    oldest = std::min(oldest, epoch);
+                }
+            }
+        }
+        std::vector<std::unique_ptr<T>> reclaimed;
+        auto still_used = std::partition(
+            s.retired.begin(), s.retired.end(),
+            [&](const retired_version& v) { return v.epoch <= oldest; });
+        for (auto it = s.retired.begin(); it != still_used; ++it) {
+            reclaimed.push_back(std::move(it->object));
+        }
+        s.retired.erase(s.retired.begin(), still_used);
+        return reclaimed;
+    }
+};
+
+} // namespace samwarring
+
+#endif
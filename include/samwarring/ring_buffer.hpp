@@ -1,10 +1,32 @@
 #ifndef INCLUDED_SAMWARRING_RING_BUFFER_HPP
 #define INCLUDED_SAMWARRING_RING_BUFFER_HPP
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <samwarring/detail/power_of_two.hpp>
 #include <type_traits>
+#include <utility>
 
 namespace samwarring {
 
+/**
+ * @brief Tag type selecting the power-of-two capacity mode of @ref
+ * ring_buffer.
+ */
+struct power_of_two_capacity_t {
+    explicit power_of_two_capacity_t() = default;
+};
+
+/**
+ * @brief Tag value selecting the power-of-two capacity mode of @ref
+ * ring_buffer.
+ */
+inline constexpr power_of_two_capacity_t power_of_two_capacity{};
+
 /**
  * Fixed-size buffer where each insertion overwrites the oldest element.
  *
@@ -13,35 +35,67 @@ namespace samwarring {
  * item. Other items remain untouched. This makes ring_buffer ideal for
  * implementing a fixed-size "sliding window" of values.
  *
- * Ring buffers are constructed with a maximum size, N, at which point all N
- * items are default-constructed. ring_buffer cannot be instantiated with
- * element types that are not default-constructable.
+ * Ring buffers are constructed with a maximum size, N, but no items. Storage
+ * for the N items is allocated up front and left uninitialized. Items are
+ * constructed in place as they are written with push_back or emplace_back,
+ * until the buffer holds N items. From then on, each new item replaces the
+ * oldest one. Only live items are ever copied or destroyed, so the element
+ * type does not need to be default-constructable.
+ *
+ * Once the buffer is full, push_back copy- or move-assigns into the oldest
+ * element when the element type supports it. Otherwise, and always for
+ * emplace_back, the new element is constructed into a temporary, the oldest
+ * element is destroyed, and the temporary is moved into its place.
  *
- * Items are written to the buffer with push_back, and the parameter is move-
- * assigned into an existing element. ring_buffer cannot be instantated with
- * element types that are not move-assignable.
+ * Batches of items are written with push_back_range, and the whole window is
+ * read out in order with copy_out. Both split the work into at most two
+ * contiguous copies, which become memcpy for trivially copyable types.
  *
  * The "back" always refers to the item most recently written to the buffer,
  * and conversely, the "front" always refers to the oldest item in the buffer.
  * Items are 0-indexed from the front.
  *
+ * The ordered iterators are random-access, so algorithms like std::sort,
+ * std::nth_element and std::lower_bound work directly on the window. When
+ * compiled as C++20, ring_buffer models std::ranges::random_access_range and
+ * std::ranges::sized_range.
+ *
+ * The capacity can be changed later with resize or shrink_to_fit, which keep
+ * the newest items and move them into new storage in at most two contiguous
+ * spans.
+ *
+ * Indices wrap around without integer division. Buffers constructed with the
+ * @ref power_of_two_capacity tag round their capacity up to a power of two and
+ * wrap indices with a bit mask instead. For a capacity known at compile time,
+ * see @ref static_ring_buffer.
+ *
+ * Storage comes from `Allocator`, and items are constructed and destroyed
+ * through std::allocator_traits. With @ref pmr::ring_buffer, many short-lived
+ * buffers can be carved out of a std::pmr::monotonic_buffer_resource or pool
+ * resource instead of going through the global heap. Allocators that
+ * propagate themselves to their items, like std::pmr::polymorphic_allocator,
+ * are passed on to items such as std::pmr::string as they are constructed.
+ *
  * Example
  * -------
  *
- *      ring_buffer<int> buf{3};  // [0, 0, 0]
- *      buf.push_back(7);         // [0, 0, 7]
- *      buf.push_back(3);         // [0, 7, 3]
+ *      ring_buffer<int> buf{3};  // []
+ *      buf.push_back(7);         // [7]
+ *      buf.push_back(3);         // [7, 3]
  *      buf.push_back(9);         // [7, 3, 9]
  *      buf.push_back(2);         // [3, 9, 2]
  */
-template <class T>
+template <class T, class Allocator = std::allocator<T>>
 class ring_buffer {
-    static_assert(std::is_default_constructible_v<T>,
-                  "Item type is not default-constructable");
-    static_assert(std::is_move_assignable_v<T>,
-                  "Item type is not move-assignable");
+    using alloc_traits = std::allocator_traits<Allocator>;
+    static_assert(std::is_same_v<typename alloc_traits::value_type, T>,
+                  "Allocator value_type does not match the item type");
+    static_assert(std::is_same_v<typename alloc_traits::pointer, T*>,
+                  "Allocator must use raw pointers");
 
   public:
+    using allocator_type = Allocator;
+
     /**
      * @name Constructors
      * @{
@@ -51,35 +105,97 @@ class ring_buffer {
      * Default constructor.
      *
      * Constructs a new ring buffer that cannot hold any items. Such instances
-     * are useless unless they are assigned the contents of another ring_buffer
-     * instance.
+     * are useless until they are resized, or assigned the contents of another
+     * ring_buffer instance.
      */
-    ring_buffer() noexcept : data_{nullptr}, capacity_{0}, next_{0} {}
+    ring_buffer() noexcept(noexcept(Allocator()))
+        : ring_buffer(Allocator()) {}
+
+    /**
+     * Constructs a ring buffer that cannot hold any items, and that will use
+     * `alloc` once it is given storage.
+     *
+     * @param alloc Allocator for the buffer's storage.
+     */
+    explicit ring_buffer(const Allocator& alloc) noexcept
+        : alloc_{alloc}, data_{nullptr}, capacity_{0}, mask_{0}, next_{0},
+          size_{0}, power_of_two_{false} {}
 
     /**
      * Main constructor.
      *
-     * Constructs a new ring buffer with `capacity` items. All items are
-     * default-constructed.
+     * Constructs a new, empty ring buffer that can hold `capacity` items.
+     * Storage is allocated, but no items are constructed.
      *
      * @param capacity Number of items in the buffer
+     * @param alloc Allocator for the buffer's storage.
      */
-    ring_buffer(std::size_t capacity)
-        : data_{new T[capacity]()}, capacity_{capacity}, next_{0} {}
+    ring_buffer(std::size_t capacity, const Allocator& alloc = Allocator())
+        : alloc_{alloc}, data_{allocate(capacity)}, capacity_{capacity},
+          mask_{0}, next_{0}, size_{0}, power_of_two_{false} {}
+
+    /**
+     * Power-of-two constructor.
+     *
+     * Constructs a new ring buffer whose capacity is `capacity` rounded up to
+     * the next power of two. Indices into the buffer are wrapped with a bit
+     * mask.
+     *
+     * @param capacity Minimum number of items in the buffer
+     * @param alloc Allocator for the buffer's storage.
+     */
+    ring_buffer(std::size_t capacity, power_of_two_capacity_t,
+                const Allocator& alloc = Allocator())
+        : ring_buffer(detail::round_up_to_power_of_two(capacity), alloc) {
+        power_of_two_ = true;
+        mask_ = capacity_ - 1;
+    }
 
     /**
      * Copy constructor.
      *
-     * Constructs a ring buffer from an existing one. The new buffer first
-     * default-constructs all elements, then copy-assigns each element from
-     * the original buffer into the new one.
+     * Constructs a ring buffer from an existing one. Only the original
+     * buffer's items are copy-constructed, from front to back, into the
+     * start of the new buffer's storage. The allocator is obtained with
+     * `select_on_container_copy_construction`.
+     *
+     * @param other The original buffer.
+     */
+    ring_buffer(const ring_buffer& other)
+        : ring_buffer(other,
+                      alloc_traits::select_on_container_copy_construction(
+                          other.alloc_)) {}
+
+    /**
+     * Copy constructor with an explicit allocator.
      *
      * @param other The original buffer.
+     * @param alloc Allocator for the new buffer's storage.
      */
-    ring_buffer(const ring_buffer<T>& other)
-        : data_{new T[other.capacity_]()}, capacity_{other.capacity_},
-          next_{other.next_} {
-        std::copy(other.data_, other.data_ + capacity_, data_);
+    ring_buffer(const ring_buffer& other, const Allocator& alloc)
+        : alloc_{alloc}, data_{allocate(other.capacity_)},
+          capacity_{other.capacity_}, mask_{other.mask_}, next_{0}, size_{0},
+          power_of_two_{other.power_of_two_} {
+        auto first = other.first_part();
+        auto second = other.second_part();
+        T* pos = data_;
+        try {
+            for (const T* it = first.begin(); it != first.end(); ++it, ++pos) {
+                alloc_traits::construct(alloc_, pos, *it);
+            }
+            for (const T* it = second.begin(); it != second.end();
+                 ++it, ++pos) {
+                alloc_traits::construct(alloc_, pos, *it);
+            }
+        } catch (...) {
+            for (T* it = data_; it != pos; ++it) {
+                alloc_traits::destroy(alloc_, it);
+            }
+            deallocate(data_, capacity_);
+            throw;
+        }
+        size_ = other.size_;
+        next_ = size_ == capacity_ ? 0 : size_;
     }
 
     /**
@@ -87,15 +203,51 @@ class ring_buffer {
      *
      * Constructs a ring buffer by stealing the contents from an existing one.
      * The moved-from buffer becomes an empty buffer with no data and no
-     * capacity.
+     * capacity. The allocator is moved along with the storage.
      *
      * @param other
      */
-    ring_buffer(ring_buffer<T>&& other)
-        : data_{other.data_}, capacity_{other.capacity_}, next_{other.next_} {
-        other.data_ = nullptr;
-        other.capacity_ = 0;
-        other.next_ = 0;
+    ring_buffer(ring_buffer&& other) noexcept
+        : alloc_{std::move(other.alloc_)}, data_{other.data_},
+          capacity_{other.capacity_}, mask_{other.mask_}, next_{other.next_},
+          size_{other.size_}, power_of_two_{other.power_of_two_} {
+        other.release();
+    }
+
+    /**
+     * Move constructor with an explicit allocator.
+     *
+     * The storage is stolen if `alloc` compares equal to the other buffer's
+     * allocator. Otherwise, new storage is allocated from `alloc` and the
+     * items are moved into it, from front to back. Either way, the
+     * moved-from buffer becomes an empty buffer with no data and no capacity.
+     *
+     * @param other
+     * @param alloc Allocator for the new buffer's storage.
+     */
+    ring_buffer(ring_buffer&& other, const Allocator& alloc)
+        : alloc_{alloc}, data_{nullptr}, capacity_{0}, mask_{0}, next_{0},
+          size_{0}, power_of_two_{false} {
+        if (alloc_ == other.alloc_) {
+            steal_storage(other);
+        } else {
+            data_ = allocate(other.capacity_);
+            capacity_ = other.capacity_;
+            mask_ = other.mask_;
+            power_of_two_ = other.power_of_two_;
+            try {
+                for (T& item : other) {
+                    emplace_back(std::move(item));
+                }
+            } catch (...) {
+                destroy_all();
+                deallocate(data_, capacity_);
+                throw;
+            }
+            other.destroy_all();
+            other.deallocate(other.data_, other.capacity_);
+            other.release();
+        }
     }
     /**
      * @} End of Constructors
@@ -104,19 +256,351 @@ class ring_buffer {
     /**
      * Destructor.
      *
-     * Destroys all items, and releases memory.
+     * Destroys all live items, and releases memory.
      */
     ~ring_buffer() {
-        delete[] data_;
+        destroy_all();
+        deallocate(data_, capacity_);
+    }
+
+    /**
+     * @name Assignment
+     * @{
+     */
+
+    /**
+     * Copy assignment.
+     *
+     * The items are copied into new storage with the same capacity as
+     * `other`'s, and then the old items are destroyed. If a copy throws, this
+     * buffer is left unchanged. The allocator is replaced by `other`'s if it
+     * propagates on container copy assignment.
+     *
+     * @param other The original buffer.
+     */
+    ring_buffer& operator=(const ring_buffer& other) {
+        if (this != &other) {
+            constexpr bool propagate =
+                alloc_traits::propagate_on_container_copy_assignment::value;
+            ring_buffer copy{other, propagate ? other.alloc_ : alloc_};
+            if constexpr (propagate) {
+                using std::swap;
+                swap(alloc_, copy.alloc_);
+            }
+            swap_storage(copy);
+        }
+        return *this;
+    }
+
+    /**
+     * Move assignment.
+     *
+     * The storage is stolen from `other` when the allocator propagates on
+     * container move assignment or compares equal to `other`'s, which is
+     * always the case for std::allocator. Otherwise, the items are moved one
+     * by one into storage from this buffer's allocator. Either way, `other`
+     * becomes an empty buffer with no data and no capacity.
+     *
+     * @param other
+     */
+    ring_buffer& operator=(ring_buffer&& other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value ||
+        alloc_traits::is_always_equal::value) {
+        if (this == &other) {
+            return *this;
+        }
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::
+                          value) {
+            destroy_all();
+            deallocate(data_, capacity_);
+            release();
+            alloc_ = std::move(other.alloc_);
+            steal_storage(other);
+        } else {
+            if (alloc_ == other.alloc_) {
+                destroy_all();
+                deallocate(data_, capacity_);
+                release();
+                steal_storage(other);
+            } else {
+                ring_buffer moved{std::move(other), alloc_};
+                swap_storage(moved);
+            }
+        }
+        return *this;
+    }
+
+    /**
+     * @} End of Assignment
+     */
+
+    allocator_type get_allocator() const noexcept {
+        return alloc_;
     }
 
     std::size_t capacity() const noexcept {
         return capacity_;
     }
 
-    void push_back(T item) noexcept(std::is_nothrow_move_assignable<T>::value) {
-        data_[next_] = std::move(item);
-        next_ = (next_ + 1) % capacity_;
+    /**
+     * @return Number of live items in the buffer, up to capacity().
+     */
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    bool full() const noexcept {
+        return size_ == capacity_;
+    }
+
+    /**
+     * Destroys all items. The capacity is unchanged.
+     */
+    void clear() noexcept {
+        destroy_all();
+        size_ = 0;
+        next_ = 0;
+    }
+
+    /**
+     * Changes the capacity, keeping the newest items in order.
+     *
+     * New storage is allocated, and the newest `min(size(), new_capacity)`
+     * items are moved to its start, in at most two contiguous spans. These
+     * become memcpy for trivially copyable types. Older items are destroyed.
+     * A buffer constructed with the @ref power_of_two_capacity tag rounds
+     * `new_capacity` up to a power of two.
+     *
+     * If moving an item may throw, items are copied instead, and the buffer
+     * is left unchanged if a copy throws.
+     *
+     * @param new_capacity Number of items the buffer can hold. With 0, the
+     * storage is released.
+     */
+    void resize(std::size_t new_capacity) {
+        if (power_of_two_ && new_capacity) {
+            new_capacity = detail::round_up_to_power_of_two(new_capacity);
+        }
+        if (new_capacity == capacity_) {
+            return;
+        }
+        const std::size_t kept = std::min(size_, new_capacity);
+        T* data = allocate(new_capacity);
+        if (kept) {
+            // The kept items are the tail of first_part() followed by
+            // second_part(), or just the tail of second_part().
+            auto first = first_part();
+            auto second = second_part();
+            const std::size_t skip = size_ - kept;
+            const auto first_size =
+                static_cast<std::size_t>(first.end() - first.begin());
+            T* pos = data;
+            try {
+                if (skip < first_size) {
+                    pos = relocate_items(first.begin() + skip, first.end(),
+                                         pos);
+                    pos = relocate_items(second.begin(), second.end(), pos);
+                } else {
+                    pos = relocate_items(second.begin() + (skip - first_size),
+                                         second.end(), pos);
+                }
+            } catch (...) {
+                destroy_items(data, pos);
+                deallocate(data, new_capacity);
+                throw;
+            }
+        }
+        destroy_all();
+        deallocate(data_, capacity_);
+        data_ = data;
+        capacity_ = new_capacity;
+        mask_ = power_of_two_ && new_capacity ? new_capacity - 1 : 0;
+        size_ = kept;
+        next_ = kept == new_capacity ? 0 : kept;
+    }
+
+    /**
+     * Reduces the capacity to the number of items, as if by resize(size()).
+     *
+     * An empty buffer releases its storage, and cannot hold items until it is
+     * resized again.
+     */
+    void shrink_to_fit() {
+        resize(size_);
+    }
+
+    void push_back(const T& item) noexcept(
+        std::is_nothrow_copy_constructible<T>::value &&
+        std::is_nothrow_copy_assignable<T>::value) {
+        if constexpr (std::is_copy_assignable_v<T>) {
+            if (full()) {
+                data_[next_] = item;
+                next_ = wrap(next_ + 1);
+                return;
+            }
+        }
+        emplace_back(item);
+    }
+
+    void push_back(T&& item) noexcept(
+        std::is_nothrow_move_constructible<T>::value &&
+        std::is_nothrow_move_assignable<T>::value) {
+        if constexpr (std::is_move_assignable_v<T>) {
+            if (full()) {
+                data_[next_] = std::move(item);
+                next_ = wrap(next_ + 1);
+                return;
+            }
+        }
+        emplace_back(std::move(item));
+    }
+
+    /**
+     * Constructs a new item at the back of the buffer.
+     *
+     * If the buffer is full, the new item is first constructed into a
+     * temporary, because the arguments may refer to the oldest item, as in
+     * `buf.emplace_back(buf.front())`. Then the oldest item is destroyed, and
+     * the temporary is moved into its slot. If the new item's constructor
+     * throws, the buffer is unchanged. If the move throws, the buffer is left
+     * without its oldest item.
+     *
+     * @param args Arguments forwarded to the item's constructor.
+     * @return Reference to the new item.
+     */
+    template <class... Args>
+    T& emplace_back(Args&&... args) noexcept(
+        noexcept(alloc_traits::construct(std::declval<Allocator&>(),
+                                         std::declval<T*>(),
+                                         std::declval<Args>()...)) &&
+        noexcept(alloc_traits::construct(std::declval<Allocator&>(),
+                                         std::declval<T*>(),
+                                         std::declval<T&&>()))) {
+        T* slot = data_ + next_;
+        if (full()) {
+            // The temporary is built through the allocator too, so that
+            // items like std::pmr::string keep the buffer's resource.
+            alignas(T) unsigned char storage[sizeof(T)];
+            T* item = reinterpret_cast<T*>(storage);
+            alloc_traits::construct(alloc_, item, std::forward<Args>(args)...);
+            struct destroy_guard {
+                Allocator& alloc;
+                T* item;
+                ~destroy_guard() {
+                    alloc_traits::destroy(alloc, item);
+                }
+            } guard{alloc_, item};
+            // Dropping the oldest item before constructing over it keeps the
+            // buffer consistent if the move throws.
+            alloc_traits::destroy(alloc_, slot);
+            --size_;
+            alloc_traits::construct(alloc_, slot, std::move(*item));
+        } else {
+            alloc_traits::construct(alloc_, slot, std::forward<Args>(args)...);
+        }
+        ++size_;
+        next_ = wrap(next_ + 1);
+        return *slot;
+    }
+
+    /**
+     * Destroys the oldest item. The buffer must not be empty.
+     */
+    void pop_front() noexcept {
+        alloc_traits::destroy(alloc_, data_ + front_index());
+        --size_;
+    }
+
+    /**
+     * Exchanges the contents of two buffers, without copying, moving or
+     * destroying any items.
+     *
+     * The allocators are swapped if the allocator propagates on container
+     * swap. Otherwise, the allocators must compare equal.
+     */
+    void swap(ring_buffer& other) noexcept {
+        using std::swap;
+        if constexpr (alloc_traits::propagate_on_container_swap::value) {
+            swap(alloc_, other.alloc_);
+        }
+        swap_storage(other);
+    }
+
+    friend void swap(ring_buffer& lhs, ring_buffer& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+    /**
+     * Pushes a range of items, as if by calling push_back on each one.
+     *
+     * For forward iterators, only the last `capacity()` items of the range
+     * are written. They are copied in at most two contiguous segments when the
+     * item type is trivially copyable, or when the buffer is full so that
+     * every destination slot already holds an item to assign over.
+     *
+     * @param first Beginning of the range.
+     * @param last End of the range.
+     */
+    template <class InputIt>
+    void push_back_range(InputIt first, InputIt last) {
+        using category =
+            typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+            auto count = static_cast<std::size_t>(std::distance(first, last));
+            if (count > capacity_) {
+                std::advance(first, count - capacity_);
+                count = capacity_;
+            }
+            if (std::is_trivially_copyable_v<T> || full()) {
+                const std::size_t until_end = capacity_ - next_;
+                if (count <= until_end) {
+                    copy_items(first, count, data_ + next_);
+                } else {
+                    std::advance(first,
+                                 copy_items(first, until_end, data_ + next_));
+                    copy_items(first, count - until_end, data_);
+                }
+                size_ = std::min(capacity_, size_ + count);
+                next_ = wrap(next_ + count);
+                return;
+            }
+            for (; count; --count, ++first) {
+                push_back(*first);
+            }
+        } else {
+            for (; first != last; ++first) {
+                push_back(*first);
+            }
+        }
+    }
+
+    /**
+     * Pushes `count` items from contiguous memory.
+     *
+     * @param items Pointer to the first item.
+     * @param count Number of items.
+     */
+    void push_back(const T* items, std::size_t count) {
+        push_back_range(items, items + count);
+    }
+
+    /**
+     * Copies all items, from front to back, to an output iterator.
+     *
+     * @param dest Beginning of the destination range.
+     * @return Output iterator past the last copied item.
+     */
+    template <class OutputIt>
+    OutputIt copy_out(OutputIt dest) const {
+        auto first = first_part();
+        auto second = second_part();
+        dest = copy_out_items(first.begin(), first.end() - first.begin(), dest);
+        return copy_out_items(second.begin(), second.end() - second.begin(),
+                              dest);
     }
 
     T& operator[](std::size_t index) noexcept {
@@ -144,15 +628,35 @@ class ring_buffer {
     }
 
   public:
+    /**
+     * Random-access iterator over items from front to back.
+     *
+     * The iterator is a pointer into the storage, plus a flag recording
+     * whether it has wrapped past the end of the storage. Together they
+     * give the iterator's distance from the start of the storage, so
+     * jumps, differences and comparisons are all O(1).
+     */
     template <class U>
     class iterator_base {
       public:
-        using iterator_category = std::forward_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
         using difference_type = std::ptrdiff_t;
         using value_type = std::remove_const_t<U>;
         using pointer = U*;
         using reference = U&;
 
+        iterator_base() noexcept = default;
+
+        /**
+         * Converts an iterator into a const_iterator.
+         */
+        template <class V, class = std::enable_if_t<
+                               std::is_same_v<U, const V> &&
+                               !std::is_same_v<U, V>>>
+        iterator_base(const iterator_base<V>& other) noexcept
+            : pos_{other.pos_}, data_begin_{other.data_begin_},
+              data_end_{other.data_end_}, rollover_{other.rollover_} {}
+
         U& operator*() const noexcept {
             return *pos_;
         }
@@ -161,12 +665,8 @@ class ring_buffer {
             return pos_;
         }
 
-        bool operator==(const iterator_base& other) const noexcept {
-            return (pos_ == other.pos_) && (rollover_ == other.rollover_);
-        }
-
-        bool operator!=(const iterator_base& other) const noexcept {
-            return (pos_ != other.pos_) || (rollover_ != other.rollover_);
+        U& operator[](difference_type n) const noexcept {
+            return *(*this + n);
         }
 
         iterator_base<U>& operator++() noexcept {
@@ -180,8 +680,84 @@ class ring_buffer {
             return tmp;
         }
 
+        iterator_base<U>& operator--() noexcept {
+            retreat();
+            return *this;
+        }
+
+        iterator_base<U> operator--(int) noexcept {
+            auto tmp = *this;
+            retreat();
+            return tmp;
+        }
+
+        iterator_base<U>& operator+=(difference_type n) noexcept {
+            seek(offset() + n);
+            return *this;
+        }
+
+        iterator_base<U>& operator-=(difference_type n) noexcept {
+            seek(offset() - n);
+            return *this;
+        }
+
+        friend iterator_base<U> operator+(iterator_base<U> it,
+                                          difference_type n) noexcept {
+            return it += n;
+        }
+
+        friend iterator_base<U> operator+(difference_type n,
+                                          iterator_base<U> it) noexcept {
+            return it += n;
+        }
+
+        friend iterator_base<U> operator-(iterator_base<U> it,
+                                          difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const iterator_base<U>& lhs,
+                                         const iterator_base<U>& rhs) noexcept {
+            return lhs.offset() - rhs.offset();
+        }
+
+        // The comparisons are hidden friends, so that comparing an iterator
+        // with a const_iterator finds const_iterator's overloads and converts
+        // the other side.
+        friend bool operator==(const iterator_base<U>& lhs,
+                               const iterator_base<U>& rhs) noexcept {
+            return (lhs.pos_ == rhs.pos_) && (lhs.rollover_ == rhs.rollover_);
+        }
+
+        friend bool operator!=(const iterator_base<U>& lhs,
+                               const iterator_base<U>& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+        friend bool operator<(const iterator_base<U>& lhs,
+                              const iterator_base<U>& rhs) noexcept {
+            return lhs.offset() < rhs.offset();
+        }
+
+        friend bool operator>(const iterator_base<U>& lhs,
+                              const iterator_base<U>& rhs) noexcept {
+            return lhs.offset() > rhs.offset();
+        }
+
+        friend bool operator<=(const iterator_base<U>& lhs,
+                               const iterator_base<U>& rhs) noexcept {
+            return lhs.offset() <= rhs.offset();
+        }
+
+        friend bool operator>=(const iterator_base<U>& lhs,
+                               const iterator_base<U>& rhs) noexcept {
+            return lhs.offset() >= rhs.offset();
+        }
+
       private:
-        friend class ring_buffer<T>;
+        friend class ring_buffer;
+        template <class V>
+        friend class iterator_base;
 
         iterator_base(U* data_begin, std::size_t capacity, U* pos,
                       bool rollover)
@@ -195,31 +771,125 @@ class ring_buffer {
             }
         }
 
-        U* pos_;
-        U* data_begin_;
-        U* data_end_;
-        bool rollover_;
+        void retreat() noexcept {
+            if (pos_ == data_begin_) {
+                pos_ = data_end_;
+                rollover_ = false;
+            }
+            --pos_;
+        }
+
+        // Distance from the start of the storage, counting a wrapped
+        // iterator as one full capacity further along.
+        difference_type offset() const noexcept {
+            return (pos_ - data_begin_) +
+                   (rollover_ ? data_end_ - data_begin_ : 0);
+        }
+
+        void seek(difference_type offset) noexcept {
+            const difference_type capacity = data_end_ - data_begin_;
+            rollover_ = offset >= capacity;
+            pos_ = data_begin_ + (rollover_ ? offset - capacity : offset);
+        }
+
+        U* pos_{nullptr};
+        U* data_begin_{nullptr};
+        U* data_end_{nullptr};
+        bool rollover_{false};
+    };
+
+    /**
+     * Forward iterator over the live items in storage order.
+     *
+     * The live items fill the storage except for at most one gap of free
+     * slots. The gap is left behind by pop_front, between the back item and
+     * the front item, and the iterator steps over it.
+     */
+    template <class U>
+    class unordered_iterator_base {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = std::remove_const_t<U>;
+        using pointer = U*;
+        using reference = U&;
+
+        unordered_iterator_base() noexcept = default;
+
+        /**
+         * Converts an unordered_iterator into a const_unordered_iterator.
+         */
+        template <class V, class = std::enable_if_t<
+                               std::is_same_v<U, const V> &&
+                               !std::is_same_v<U, V>>>
+        unordered_iterator_base(
+            const unordered_iterator_base<V>& other) noexcept
+            : pos_{other.pos_}, gap_begin_{other.gap_begin_},
+              gap_end_{other.gap_end_} {}
+
+        U& operator*() const noexcept {
+            return *pos_;
+        }
+
+        U* operator->() const noexcept {
+            return pos_;
+        }
+
+        unordered_iterator_base<U>& operator++() noexcept {
+            if (++pos_ == gap_begin_) {
+                pos_ = gap_end_;
+            }
+            return *this;
+        }
+
+        unordered_iterator_base<U> operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        friend bool operator==(const unordered_iterator_base<U>& lhs,
+                               const unordered_iterator_base<U>& rhs) noexcept {
+            return lhs.pos_ == rhs.pos_;
+        }
+
+        friend bool operator!=(const unordered_iterator_base<U>& lhs,
+                               const unordered_iterator_base<U>& rhs) noexcept {
+            return lhs.pos_ != rhs.pos_;
+        }
+
+      private:
+        friend class ring_buffer;
+        template <class V>
+        friend class unordered_iterator_base;
+
+        unordered_iterator_base(U* pos, U* gap_begin, U* gap_end) noexcept
+            : pos_{pos}, gap_begin_{gap_begin}, gap_end_{gap_end} {}
+
+        U* pos_{nullptr};
+        U* gap_begin_{nullptr};
+        U* gap_end_{nullptr};
     };
 
     using iterator = iterator_base<T>;
     using const_iterator = iterator_base<const T>;
-    using unordered_iterator = T*;
-    using const_unordered_iterator = const T*;
+    using unordered_iterator = unordered_iterator_base<T>;
+    using const_unordered_iterator = unordered_iterator_base<const T>;
     using partial_iterator = T*;
 
     template <class U>
     class partition_base {
       public:
-        partial_iterator begin() noexcept {
+        U* begin() const noexcept {
             return begin_;
         }
 
-        partial_iterator end() noexcept {
+        U* end() const noexcept {
             return end_;
         }
 
       private:
-        friend class ring_buffer<T>;
+        friend class ring_buffer;
         partition_base(U* begin, U* end) : begin_{begin}, end_{end} {}
 
         U* begin_;
@@ -238,48 +908,97 @@ class ring_buffer {
     }
 
     iterator end() noexcept {
-        return iterator{data_, capacity_, data_ + front_index(), true};
+        const std::size_t back_end = front_index() + size_;
+        const bool rollover = size_ != 0 && back_end >= capacity_;
+        return iterator{data_, capacity_,
+                        data_ + (rollover ? back_end - capacity_ : back_end),
+                        rollover};
     }
 
     const_iterator end() const noexcept {
-        return const_iterator{data_, capacity_, data_ + front_index(), true};
+        const std::size_t back_end = front_index() + size_;
+        const bool rollover = size_ != 0 && back_end >= capacity_;
+        return const_iterator{
+            data_, capacity_,
+            data_ + (rollover ? back_end - capacity_ : back_end), rollover};
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
     }
 
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    /**
+     * Unordered iteration visits exactly the live items, in storage order.
+     * Once items wrap around the end of the storage, the items at its start
+     * come first, then the free slots left by pop_front are skipped.
+     */
     unordered_iterator unordered_begin() noexcept {
-        return data_;
+        return make_unordered_begin<T>(data_);
     }
 
     const_unordered_iterator unordered_begin() const noexcept {
-        return data_;
+        return make_unordered_begin<const T>(data_);
     }
 
     unordered_iterator unordered_end() noexcept {
-        return data_ + capacity_;
+        return unordered_iterator{data_ + first_part_end(), nullptr, nullptr};
     }
 
     const_unordered_iterator unordered_end() const noexcept {
-        return data_ + capacity_;
+        return const_unordered_iterator{data_ + first_part_end(), nullptr,
+                                        nullptr};
     }
 
     partition first_part() noexcept {
-        return partition{data_ + next_, data_ + capacity_};
+        return partition{data_ + front_index(), data_ + first_part_end()};
     }
 
     const_partition first_part() const noexcept {
-        return const_partition{data_ + next_, data_ + capacity_};
+        return const_partition{data_ + front_index(),
+                               data_ + first_part_end()};
     }
 
     partition second_part() noexcept {
-        return partition{data_, data_ + next_};
+        return partition{data_, data_ + second_part_end()};
     }
 
     const_partition second_part() const noexcept {
-        return const_partition{data_, data_ + next_};
+        return const_partition{data_, data_ + second_part_end()};
     }
 
   private:
     std::size_t front_index() const noexcept {
-        return next_;
+        return wrap(next_ + capacity_ - size_);
+    }
+
+    // The live items run from front_index() up to either the end of the
+    // storage, or up to front_index() + size_ if that comes first. Any
+    // remaining items wrap around to the start of the storage.
+    std::size_t first_part_end() const noexcept {
+        return std::min(front_index() + size_, capacity_);
+    }
+
+    std::size_t second_part_end() const noexcept {
+        const std::size_t back_end = front_index() + size_;
+        return back_end > capacity_ ? back_end - capacity_ : 0;
+    }
+
+    // When the items wrap, iteration starts with second_part() and jumps from
+    // its end to the start of first_part(). Otherwise it covers first_part().
+    // Either way it ends at the end of first_part().
+    template <class U>
+    unordered_iterator_base<U> make_unordered_begin(U* data) const noexcept {
+        const std::size_t second_end = second_part_end();
+        if (second_end == 0) {
+            return unordered_iterator_base<U>{data + front_index(), nullptr,
+                                              nullptr};
+        }
+        return unordered_iterator_base<U>{data, data + second_end,
+                                          data + front_index()};
     }
 
     std::size_t back_index() const noexcept {
@@ -287,14 +1006,170 @@ class ring_buffer {
     }
 
     std::size_t nth_index(std::size_t index) const noexcept {
-        return (next_ + index) % capacity_;
+        return wrap(front_index() + index);
+    }
+
+    // Maps a position in [0, 2 * capacity) back into [0, capacity).
+    std::size_t wrap(std::size_t index) const noexcept {
+        if (mask_) {
+            return index & mask_;
+        }
+        return index >= capacity_ ? index - capacity_ : index;
+    }
+
+    // Copies `count` items from `src` over the items at `dest`. The
+    // destination slots must hold live items, unless T is trivially copyable.
+    // Returns `count`, so the caller can advance `src`.
+    template <class It>
+    static std::size_t copy_items(It src, std::size_t count, T* dest) {
+        if constexpr (std::is_trivially_copyable_v<T> &&
+                      (std::is_same_v<It, T*> ||
+                       std::is_same_v<It, const T*>)) {
+            if (count) {
+                std::memcpy(dest, src, count * sizeof(T));
+            }
+        } else {
+            std::copy_n(src, count, dest);
+        }
+        return count;
+    }
+
+    template <class OutputIt>
+    static OutputIt copy_out_items(const T* src, std::size_t count,
+                                   OutputIt dest) {
+        if constexpr (std::is_trivially_copyable_v<T> &&
+                      std::is_same_v<OutputIt, T*>) {
+            if (count) {
+                std::memcpy(dest, src, count * sizeof(T));
+            }
+            return dest + count;
+        } else {
+            return std::copy_n(src, count, dest);
+        }
+    }
+
+    void destroy_all() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T> ||
+                      !std::is_same_v<Allocator, std::allocator<T>>) {
+            auto first = first_part();
+            auto second = second_part();
+            for (T* it = first.begin(); it != first.end(); ++it) {
+                alloc_traits::destroy(alloc_, it);
+            }
+            for (T* it = second.begin(); it != second.end(); ++it) {
+                alloc_traits::destroy(alloc_, it);
+            }
+        }
+    }
+
+    // Whether constructing or destroying an item through the allocator is
+    // just a byte copy or a no-op, so that items can be moved with memcpy.
+    static constexpr bool plain_storage =
+        std::is_trivially_copyable_v<T> &&
+        std::is_same_v<Allocator, std::allocator<T>>;
+
+    // Moves the items in [first, last) into uninitialized storage at `dest`,
+    // or copies them if moving may throw. On exception, the items already
+    // constructed are destroyed. Returns the end of the constructed items.
+    T* relocate_items(T* first, T* last, T* dest) {
+        if constexpr (plain_storage) {
+            if (first != last) {
+                std::memcpy(dest, first, (last - first) * sizeof(T));
+            }
+            return dest + (last - first);
+        } else {
+            T* pos = dest;
+            try {
+                for (; first != last; ++first, ++pos) {
+                    alloc_traits::construct(alloc_, pos,
+                                            std::move_if_noexcept(*first));
+                }
+            } catch (...) {
+                destroy_items(dest, pos);
+                throw;
+            }
+            return pos;
+        }
+    }
+
+    void destroy_items(T* first, T* last) noexcept {
+        for (; first != last; ++first) {
+            alloc_traits::destroy(alloc_, first);
+        }
+    }
+
+    // Takes the storage of `other`, which must come from an equal allocator.
+    // This buffer must not own any storage.
+    void steal_storage(ring_buffer& other) noexcept {
+        data_ = other.data_;
+        capacity_ = other.capacity_;
+        mask_ = other.mask_;
+        next_ = other.next_;
+        size_ = other.size_;
+        power_of_two_ = other.power_of_two_;
+        other.release();
+    }
+
+    // Exchanges storage, but not allocators.
+    void swap_storage(ring_buffer& other) noexcept {
+        using std::swap;
+        swap(data_, other.data_);
+        swap(capacity_, other.capacity_);
+        swap(mask_, other.mask_);
+        swap(next_, other.next_);
+        swap(size_, other.size_);
+        swap(power_of_two_, other.power_of_two_);
+    }
+
+    // Forgets the storage without destroying items or releasing memory.
+    void release() noexcept {
+        data_ = nullptr;
+        capacity_ = 0;
+        mask_ = 0;
+        next_ = 0;
+        size_ = 0;
+        power_of_two_ = false;
+    }
+
+    T* allocate(std::size_t capacity) {
+        return capacity ? alloc_traits::allocate(alloc_, capacity) : nullptr;
     }
 
+    void deallocate(T* data, std::size_t capacity) noexcept {
+        if (data) {
+            alloc_traits::deallocate(alloc_, data, capacity);
+        }
+    }
+
+    Allocator alloc_;
     T* data_;
     std::size_t capacity_;
+    // capacity_ - 1 in power-of-two mode with a capacity above 1, otherwise 0.
+    std::size_t mask_;
     std::size_t next_;
+    std::size_t size_;
+    // Whether the capacity is kept a power of two, even while it is 0 or 1.
+    bool power_of_two_;
 };
 
+namespace pmr {
+
+/**
+ * @brief A @ref samwarring::ring_buffer whose storage comes from a
+ * std::pmr::memory_resource.
+ *
+ * Example
+ * -------
+ *
+ *      std::pmr::monotonic_buffer_resource arena{1 << 20};
+ *      samwarring::pmr::ring_buffer<int> window{256, &arena};
+ */
+template <class T>
+using ring_buffer =
+    samwarring::ring_buffer<T, std::pmr::polymorphic_allocator<T>>;
+
+} // namespace pmr
+
 } // namespace samwarring
 
 #endif
\ No newline at end of file
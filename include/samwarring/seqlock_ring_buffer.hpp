@@ -0,0 +1,213 @@
+#ifndef INCLUDED_SAMWARRING_SEQLOCK_RING_BUFFER_HPP
+#define INCLUDED_SAMWARRING_SEQLOCK_RING_BUFFER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <samwarring/detail/cache_line.hpp>
+#include <samwarring/detail/power_of_two.hpp>
+#include <type_traits>
+#include <vector>
+
+namespace samwarring {
+
+/**
+ * @brief Overwriting ring buffer for one writer thread and any number of
+ * reader threads, where the writer never waits.
+ *
+ * Like @ref ring_buffer, each push overwrites the oldest item once the buffer
+ * is full. Readers copy items out without taking a lock, so a slow reader can
+ * never hold up the writer. Instead, a reader that falls behind loses the
+ * items that were overwritten while it was reading, which suits metrics and
+ * other data where the latest values matter most.
+ *
+ * Every push is given a position, counting from 0. Each slot carries a
+ * sequence counter, which the writer makes odd while it rewrites the slot and
+ * then sets to an even value derived from the position it holds. A reader
+ * checks the counter before and after copying a slot, and discards the copy
+ * if it changed or if the slot holds a different position than expected.
+ * Items are copied word by word through relaxed atomics, so a torn copy is
+ * detected rather than being undefined behavior. A slot only changes when a
+ * newer position overwrites it, so a torn copy means the item is lost, and
+ * there is nothing for the reader to retry.
+ *
+ * Reads return the newest intact run of the requested positions. They copy
+ * from newest to oldest and stop at the first position that has already been
+ * overwritten, since every older position has been overwritten too.
+ *
+ * Example
+ * -------
+ *
+ *      seqlock_ring_buffer<sample> samples{1024};
+ *
+ *      // Writer thread
+ *      samples.push_back(sample{now, value});
+ *
+ *      // Any reader thread
+ *      for (const sample& s : samples.snapshot()) {
+ *          plot(s);
+ *      }
+ *
+ * @tparam T Trivially copyable item type, aligned to at most 8 bytes.
+ */
+template <class T>
+class seqlock_ring_buffer {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Item type is not trivially copyable");
+    static_assert(alignof(T) <= alignof(std::uint64_t),
+                  "Item type is over-aligned");
+
+  public:
+    using value_type = T;
+
+    /**
+     * @brief Positions copied by a read. They are `first` through `first +
+     * count - 1`, stored oldest first.
+     */
+    struct range {
+        std::uint64_t first;
+        std::size_t count;
+    };
+
+    /**
+     * @brief Constructs an empty buffer.
+     *
+     * @param capacity Minimum number of items kept. It is rounded up to a
+     * power of two.
+     */
+    explicit seqlock_ring_buffer(std::size_t capacity)
+        : mask_{detail::round_up_to_power_of_two(capacity) - 1},
+          slots_{std::make_unique<slot[]>(mask_ + 1)} {}
+
+    seqlock_ring_buffer(const seqlock_ring_buffer&) = delete;
+    seqlock_ring_buffer& operator=(const seqlock_ring_buffer&) = delete;
+
+    std::size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    /**
+     * @return Number of items pushed so far, which is also the position of
+     * the next push.
+     */
+    std::uint64_t head() const noexcept {
+        return head_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Pushes an item, overwriting the oldest item if the buffer is
+     * full. Only called by the writer thread.
+     */
+    void push_back(const T& item) noexcept {
+        std::uint64_t words[word_count] = {};
+        std::memcpy(words, &item, sizeof(T));
+
+        const std::uint64_t position = head_.load(std::memory_order_relaxed);
+        slot& s = slots_[position & mask_];
+        s.seq.store(2 * position + 1, std::memory_order_relaxed);
+        // Keeps the item's words from being written before the odd counter.
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < word_count; ++i) {
+            s.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        s.seq.store(2 * position + 2, std::memory_order_release);
+        head_.store(position + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copies the item at `position`.
+     *
+     * @return true if the item was copied, or false if it has not been
+     * pushed yet or has been overwritten.
+     */
+    bool try_read(std::uint64_t position, T& out) const noexcept {
+        if (position >= head()) {
+            return false;
+        }
+        return read_slot(position, out);
+    }
+
+    /**
+     * @brief Copies the items at positions `first` up to `last`, oldest
+     * first.
+     *
+     * Positions that have not been pushed yet are left out, and so are
+     * positions that were overwritten before they could be copied.
+     *
+     * @param out Room for at least `last - first` items.
+     * @return Positions that were copied into the front of `out`.
+     */
+    range read(std::uint64_t first, std::uint64_t last, T* out) const {
+        last = std::min(last, head());
+        if (first >= last) {
+            return {last, 0};
+        }
+        if (last - first > capacity()) {
+            first = last - capacity();
+        }
+        std::uint64_t copied = last;
+        while (copied > first &&
+               read_slot(copied - 1, out[copied - 1 - first])) {
+            --copied;
+        }
+        if (copied != first) {
+            std::memmove(out, out + (copied - first),
+                         (last - copied) * sizeof(T));
+        }
+        return {copied, static_cast<std::size_t>(last - copied)};
+    }
+
+    /**
+     * @return Copy of the newest intact run of items in the buffer, oldest
+     * first.
+     */
+    std::vector<T> snapshot() const {
+        const std::uint64_t last = head();
+        const std::uint64_t first = last > capacity() ? last - capacity() : 0;
+        std::vector<T> items(static_cast<std::size_t>(last - first));
+        items.resize(read(first, last, items.data()).count);
+        return items;
+    }
+
+  private:
+    static constexpr std::size_t word_count =
+        (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    struct slot {
+        std::atomic<std::uint64_t> seq{0};
+        std::atomic<std::uint64_t> words[word_count];
+    };
+
+    bool read_slot(std::uint64_t position, T& out) const noexcept {
+        const slot& s = slots_[position & mask_];
+        const std::uint64_t seq = s.seq.load(std::memory_order_acquire);
+        if (seq != 2 * position + 2) {
+            return false;
+        }
+        std::uint64_t words[word_count];
+        for (std::size_t i = 0; i < word_count; ++i) {
+            words[i] = s.words[i].load(std::memory_order_relaxed);
+        }
+        // Keeps the counter from being re-read before the item's words.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s.seq.load(std::memory_order_relaxed) != seq) {
+            return false;
+        }
+        std::memcpy(&out, words, sizeof(T));
+        return true;
+    }
+
+    // Read-only after construction.
+    const std::size_t mask_;
+    const std::unique_ptr<slot[]> slots_;
+
+    // Written only by the writer, on its own cache line.
+    alignas(detail::cache_line_size) std::atomic<std::uint64_t> head_{0};
+};
+
+} // namespace samwarring
+
+#endif
@@ -0,0 +1,255 @@
+#ifndef INCLUDED_SAMWARRING_SHARDED_RING_BUFFER_HPP
+#define INCLUDED_SAMWARRING_SHARDED_RING_BUFFER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <samwarring/detail/cache_line.hpp>
+#include <samwarring/detail/thread_ordinal.hpp>
+#include <samwarring/ring_buffer.hpp>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace samwarring {
+
+namespace detail {
+
+/**
+ * @brief Reads a cheap timestamp that increases across the whole machine.
+ *
+ * On x86, this is the time-stamp counter, which modern CPUs keep invariant
+ * and synchronized between cores. Elsewhere, it is std::chrono::steady_clock
+ * in nanoseconds.
+ */
+inline std::uint64_t read_timestamp() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+#endif
+}
+
+} // namespace detail
+
+/**
+ * @brief Collection of ring buffers, one per writing thread, that is read
+ * back as a single window in global order.
+ *
+ * Many threads recording high-rate events into one synchronized ring all
+ * write the same cache lines, which bounce between their cores. A
+ * sharded_ring_buffer gives each writer its own shard instead: a @ref
+ * ring_buffer with its own lock, on its own cache lines. Both the shard and
+ * the ring's storage are cache-line aligned and padded to whole lines. Each
+ * entry is stamped with detail::read_timestamp() as it is written. Writers
+ * never write to a cache line shared with another shard, and their lock is
+ * uncontended except while a reader copies that shard.
+ *
+ * Threads are assigned to shards round-robin, in the order they first use
+ * any sharded type. If there are more threads than shards, some threads
+ * share a shard.
+ *
+ * Ordering only costs anything when someone reads. snapshot() and for_each()
+ * copy each shard under its lock, one at a time, and then k-way merge the
+ * copies by timestamp in O(n log k) for n entries in k shards. Entries with
+ * equal timestamps are ordered by shard.
+ *
+ * Each shard keeps the last `capacity_per_shard` entries written to it, so a
+ * busy shard's window may cover less time than a quiet one's.
+ *
+ * Example
+ * -------
+ *
+ *      sharded_ring_buffer<event> events{4096};
+ *
+ *      // Any thread
+ *      events.push_back(event{...});
+ *
+ *      // Reader
+ *      for (const auto& e : events.snapshot()) {
+ *          print(e.stamp, e.value);
+ *      }
+ *
+ * @tparam T Value type. It must be copyable so that shards can be copied out.
+ */
+template <class T>
+class sharded_ring_buffer {
+  public:
+    using value_type = T;
+
+    /**
+     * @brief A value and the timestamp it was written at.
+     */
+    struct entry {
+        std::uint64_t stamp;
+        T value;
+    };
+
+    /**
+     * @return The number of hardware threads, or 1 if it is unknown.
+     */
+    static std::size_t default_shard_count() noexcept {
+        const unsigned n = std::thread::hardware_concurrency();
+        return n ? n : 1;
+    }
+
+    /**
+     * @brief Constructs empty shards.
+     *
+     * @param capacity_per_shard Number of entries each shard keeps. Must be
+     * non-zero.
+     * @param shard_count Number of shards. Must be non-zero.
+     * @throws std::invalid_argument if either argument is zero.
+     */
+    explicit sharded_ring_buffer(
+        std::size_t capacity_per_shard,
+        std::size_t shard_count = default_shard_count()) {
+        if (capacity_per_shard == 0 || shard_count == 0) {
+            throw std::invalid_argument{
+                "capacity_per_shard and shard_count must be non-zero"};
+        }
+        shards_.reserve(shard_count);
+        for (std::size_t i = 0; i < shard_count; ++i) {
+            shards_.push_back(std::make_unique<shard>(capacity_per_shard));
+        }
+    }
+
+    sharded_ring_buffer(const sharded_ring_buffer&) = delete;
+    sharded_ring_buffer& operator=(const sharded_ring_buffer&) = delete;
+
+    std::size_t shard_count() const noexcept {
+        return shards_.size();
+    }
+
+    std::size_t capacity_per_shard() const noexcept {
+        return shards_.front()->entries.capacity();
+    }
+
+    /**
+     * @brief Writes a value into the calling thread's shard, overwriting the
+     * shard's oldest entry if it is full.
+     */
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    /**
+     * @brief Constructs a value in the calling thread's shard, overwriting
+     * the shard's oldest entry if it is full.
+     */
+    template <class... Args>
+    void emplace_back(Args&&... args) {
+        shard& s = *shards_[detail::this_thread_ordinal() % shards_.size()];
+        std::lock_guard<std::mutex> lock{s.mutex};
+        // Threads sharing a shard, or a thread that migrated to a core with
+        // a lagging counter, must not put the shard out of order.
+        s.last_stamp = std::max(s.last_stamp, detail::read_timestamp());
+        s.entries.emplace_back(
+            entry{s.last_stamp, T(std::forward<Args>(args)...)});
+    }
+
+    /**
+     * @return Total number of entries in all shards. Only a snapshot while
+     * other threads are writing.
+     */
+    std::size_t size() const {
+        std::size_t n = 0;
+        for (const auto& s : shards_) {
+            std::lock_guard<std::mutex> lock{s->mutex};
+            n += s->entries.size();
+        }
+        return n;
+    }
+
+    /**
+     * @brief Removes every entry from every shard.
+     */
+    void clear() {
+        for (const auto& s : shards_) {
+            std::lock_guard<std::mutex> lock{s->mutex};
+            s->entries.clear();
+        }
+    }
+
+    /**
+     * @brief Calls `fn(const entry&)` for every entry, in timestamp order.
+     *
+     * Each shard is copied under its lock, so `fn` runs without blocking any
+     * writer. Entries written while the shards are being copied may or may
+     * not be visited.
+     */
+    template <class Fn>
+    void for_each(Fn fn) const {
+        std::vector<std::vector<entry>> copies(shards_.size());
+        for (std::size_t i = 0; i < shards_.size(); ++i) {
+            std::lock_guard<std::mutex> lock{shards_[i]->mutex};
+            copies[i].assign(shards_[i]->entries.begin(),
+                             shards_[i]->entries.end());
+        }
+
+        // Each cursor is the stamp of a shard's next entry, and the shard.
+        using cursor = std::pair<std::uint64_t, std::size_t>;
+        std::priority_queue<cursor, std::vector<cursor>, std::greater<cursor>>
+            heap;
+        std::vector<std::size_t> next(copies.size(), 0);
+        for (std::size_t i = 0; i < copies.size(); ++i) {
+            if (!copies[i].empty()) {
+                heap.push({copies[i].front().stamp, i});
+            }
+        }
+        while (!heap.empty()) {
+            const std::size_t i = heap.top().second;
+            heap.pop();
+            fn(static_cast<const entry&>(copies[i][next[i]]));
+            if (++next[i] < copies[i].size()) {
+                heap.push({copies[i][next[i]].stamp, i});
+            }
+        }
+    }
+
+    /**
+     * @return Copy of every entry, in timestamp order.
+     */
+    std::vector<entry> snapshot() const {
+        std::vector<entry> merged;
+        for_each([&](const entry& e) { merged.push_back(e); });
+        return merged;
+    }
+
+  private:
+    struct alignas(detail::cache_line_size) shard {
+        explicit shard(std::size_t capacity) : entries{capacity} {}
+
+        mutable std::mutex mutex;
+        // Aligned separately, so that no two shards' entries share a line.
+        ring_buffer<entry, detail::cache_aligned_allocator<entry>> entries;
+        std::uint64_t last_stamp{0};
+    };
+
+    // Read-only after construction. Each shard is a separate cache-aligned
+    // allocation.
+    std::vector<std::unique_ptr<shard>> shards_;
+};
+
+} // namespace samwarring
+
+#endif
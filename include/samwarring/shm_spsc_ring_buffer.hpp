@@ -0,0 +1,505 @@
+#ifndef INCLUDED_SAMWARRING_SHM_SPSC_RING_BUFFER_HPP
+#define INCLUDED_SAMWARRING_SHM_SPSC_RING_BUFFER_HPP
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <new>
+#include <samwarring/detail/cache_line.hpp>
+#include <samwarring/detail/futex.hpp>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <type_traits>
+#include <unistd.h>
+
+namespace samwarring {
+
+namespace detail {
+
+/**
+ * @brief Control block at the start of a @ref shm_spsc_ring_buffer segment.
+ *
+ * The head and tail are free-running 32-bit counters, so that they can double
+ * as futex words. Slot indices are the counters masked by `capacity - 1`.
+ */
+struct shm_spsc_header {
+    std::atomic<std::uint64_t> magic; // Stored last by the creator.
+    std::uint64_t item_size;
+    std::uint64_t capacity;
+
+    // Written by the producer.
+    alignas(cache_line_size) std::atomic<std::uint32_t> tail;
+    std::atomic<std::uint32_t> consumer_waiting;
+
+    // Written by the consumer.
+    alignas(cache_line_size) std::atomic<std::uint32_t> head;
+    std::atomic<std::uint32_t> producer_waiting;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "64-bit atomics are not lock-free, so cannot be shared between "
+              "processes");
+
+} // namespace detail
+
+/**
+ * @brief Bounded queue for one producer process and one consumer process,
+ * in a POSIX shared memory segment.
+ *
+ * The segment has the layout of @ref spsc_ring_buffer: a control block with
+ * the tail and head on separate cache lines, followed by the slots. One
+ * process creates the segment by name, and the other opens it by name. Both
+ * then map the same pages, so a record is written into its slot by the
+ * producer and read from that same slot by the consumer, with no copies
+ * through the kernel.
+ *
+ * The producer writes records in place with try_reserve (or reserve) and
+ * publishes them with commit. The consumer reads them in place with try_peek
+ * (or peek) and frees the slot with release. try_push and try_pop (and their
+ * blocking forms, push and pop) wrap these for records that are copied in
+ * and out.
+ *
+ * The fast path is a handful of loads and stores on shared memory. Only when
+ * the queue is empty (for the consumer) or full (for the producer) does the
+ * blocking form sleep on a futex, and only then does the other side make a
+ * system call to wake it.
+ *
+ * The capacity is rounded up to a power of two. The segment outlives both
+ * processes until it is removed with @ref remove.
+ *
+ * This class is only available on Linux.
+ *
+ * Example
+ * -------
+ *
+ *      // Collector process
+ *      shm_spsc_ring_buffer<record> queue{"/collector", 4096};
+ *      record* r = queue.reserve();
+ *      fill(*r);
+ *      queue.commit();
+ *
+ *      // Exporter process
+ *      shm_spsc_ring_buffer<record> queue{"/collector"};
+ *      const record* r = queue.peek();
+ *      export(*r);
+ *      queue.release();
+ *
+ * @tparam T Record type. Must be trivially copyable, since records are shared
+ * between processes as raw bytes.
+ */
+template <class T>
+class shm_spsc_ring_buffer {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Item type is not trivially copyable");
+
+  public:
+    /**
+     * @brief Identifies the segment format: "SWSPSC01".
+     */
+    static constexpr std::uint64_t magic = 0x3130435053505753;
+
+    /**
+     * @brief Creates a new segment holding an empty queue.
+     *
+     * @param name Name of the segment, as given to shm_open(3). It must start
+     * with a slash, and must not already exist.
+     * @param capacity Minimum number of records in the queue. It is rounded
+     * up to a power of two. Must be between 1 and 2^31.
+     * @throws std::invalid_argument if `capacity` is out of range.
+     * @throws std::system_error if the segment cannot be created or mapped.
+     */
+    shm_spsc_ring_buffer(const std::string& name, std::size_t capacity) {
+        if (capacity == 0 || capacity > (std::size_t{1} << 31)) {
+            throw std::invalid_argument{"capacity must be in [1, 2^31]"};
+        }
+        capacity_ = 1;
+        while (capacity_ < capacity) {
+            capacity_ <<= 1;
+        }
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd == -1) {
+            throw_system_error("shm_open");
+        }
+        if (::ftruncate(fd, static_cast<off_t>(segment_size())) == -1) {
+            int err = errno;
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw_system_error("ftruncate", err);
+        }
+        try {
+            map(fd);
+        } catch (...) {
+            ::shm_unlink(name.c_str());
+            throw;
+        }
+        auto* header = ::new (static_cast<void*>(header_))
+            detail::shm_spsc_header{};
+        header->item_size = sizeof(T);
+        header->capacity = capacity_;
+        header->magic.store(magic, std::memory_order_release);
+    }
+
+    /**
+     * @brief Opens a segment created by another process.
+     *
+     * @param name Name the segment was created with.
+     * @throws std::system_error if the segment cannot be opened or mapped.
+     * @throws std::runtime_error if the segment was created for another
+     * record size, or is not a shm_spsc_ring_buffer segment.
+     */
+    explicit shm_spsc_ring_buffer(const std::string& name) {
+        int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd == -1) {
+            throw_system_error("shm_open");
+        }
+        struct stat st;
+        if (::fstat(fd, &st) == -1) {
+            int err = errno;
+            ::close(fd);
+            throw_system_error("fstat", err);
+        }
+        const auto size = static_cast<std::size_t>(st.st_size);
+        if (size < slots_offset()) {
+            ::close(fd);
+            throw std::runtime_error{name + ": not a shm_spsc_ring_buffer"};
+        }
+        capacity_ = (size - slots_offset()) / sizeof(T);
+        map(fd);
+        const detail::shm_spsc_header& header = *header_;
+        if (header.magic.load(std::memory_order_acquire) != magic ||
+            header.item_size != sizeof(T) || header.capacity != capacity_ ||
+            size != segment_size()) {
+            ::munmap(header_, segment_size());
+            header_ = nullptr;
+            throw std::runtime_error{name + ": not a shm_spsc_ring_buffer of "
+                                            "this record type"};
+        }
+        head_cache_ = header.head.load(std::memory_order_acquire);
+        tail_cache_ = header.tail.load(std::memory_order_acquire);
+    }
+
+    shm_spsc_ring_buffer(const shm_spsc_ring_buffer&) = delete;
+    shm_spsc_ring_buffer& operator=(const shm_spsc_ring_buffer&) = delete;
+
+    /**
+     * @brief Takes ownership of another handle's mapping.
+     */
+    shm_spsc_ring_buffer(shm_spsc_ring_buffer&& other) noexcept
+        : header_{other.header_}, data_{other.data_},
+          capacity_{other.capacity_}, head_cache_{other.head_cache_},
+          tail_cache_{other.tail_cache_} {
+        other.header_ = nullptr;
+        other.data_ = nullptr;
+    }
+
+    /**
+     * @brief Unmaps the segment. The segment itself remains until removed.
+     */
+    ~shm_spsc_ring_buffer() {
+        if (header_) {
+            ::munmap(header_, segment_size());
+        }
+    }
+
+    /**
+     * @brief Removes a segment's name. Processes that have it mapped may
+     * keep using it.
+     */
+    static void remove(const std::string& name) noexcept {
+        ::shm_unlink(name.c_str());
+    }
+
+    std::size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    /**
+     * @brief Returns the number of records in the queue. The result is only
+     * a snapshot while the other process is active.
+     */
+    std::size_t size() const noexcept {
+        return header_->tail.load(std::memory_order_acquire) -
+               header_->head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    /**
+     * @name Producer functions
+     * @{
+     */
+
+    /**
+     * @brief Returns the slot for the next record, or nullptr if the queue is
+     * full.
+     *
+     * The record becomes visible to the consumer when commit() is called.
+     * Calling try_reserve again before commit returns the same slot.
+     */
+    T* try_reserve() noexcept {
+        const std::uint32_t tail =
+            header_->tail.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == capacity_) {
+            head_cache_ = header_->head.load(std::memory_order_acquire);
+            if (tail - head_cache_ == capacity_) {
+                return nullptr;
+            }
+        }
+        return data_ + (tail & (capacity_ - 1));
+    }
+
+    /**
+     * @brief Returns the slot for the next record, sleeping while the queue
+     * is full.
+     */
+    T* reserve() noexcept {
+        T* slot;
+        while (!(slot = try_reserve())) {
+            wait_while_full();
+        }
+        return slot;
+    }
+
+    /**
+     * @brief Publishes the record written to the reserved slot.
+     */
+    void commit() noexcept {
+        detail::shm_spsc_header& header = *header_;
+        header.tail.store(header.tail.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_release);
+        // Pairs with the fence in wait_while_empty. Either the consumer sees
+        // the new tail, or this sees that the consumer is waiting. Clearing
+        // the flag means only the first commit after it goes to sleep makes
+        // a system call, even if the consumer is slow to be scheduled.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (header.consumer_waiting.load(std::memory_order_relaxed) &&
+            header.consumer_waiting.exchange(0, std::memory_order_relaxed)) {
+            detail::futex_wake(header.tail);
+        }
+    }
+
+    /**
+     * @return true if `item` was pushed, or false if the queue was full.
+     */
+    bool try_push(const T& item) noexcept {
+        T* slot = try_reserve();
+        if (!slot) {
+            return false;
+        }
+        *slot = item;
+        commit();
+        return true;
+    }
+
+    /**
+     * @brief Pushes `item`, sleeping while the queue is full.
+     */
+    void push(const T& item) noexcept {
+        *reserve() = item;
+        commit();
+    }
+
+    /**
+     * @} End of Producer functions
+     */
+
+    /**
+     * @name Consumer functions
+     * @{
+     */
+
+    /**
+     * @brief Returns the oldest record, or nullptr if the queue is empty.
+     *
+     * The record stays in the queue until release() is called.
+     */
+    const T* try_peek() noexcept {
+        const std::uint32_t head =
+            header_->head.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = header_->tail.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return nullptr;
+            }
+        }
+        return data_ + (head & (capacity_ - 1));
+    }
+
+    /**
+     * @brief Returns the oldest record, sleeping while the queue is empty.
+     */
+    const T* peek() noexcept {
+        const T* slot;
+        while (!(slot = try_peek())) {
+            wait_while_empty();
+        }
+        return slot;
+    }
+
+    /**
+     * @brief Removes the oldest record, freeing its slot for the producer.
+     */
+    void release() noexcept {
+        release(1);
+    }
+
+    /**
+     * @brief Removes the `count` oldest records at once.
+     */
+    void release(std::size_t count) noexcept {
+        detail::shm_spsc_header& header = *header_;
+        header.head.store(header.head.load(std::memory_order_relaxed) +
+                              static_cast<std::uint32_t>(count),
+                          std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (header.producer_waiting.load(std::memory_order_relaxed) &&
+            header.producer_waiting.exchange(0, std::memory_order_relaxed)) {
+            detail::futex_wake(header.head);
+        }
+    }
+
+    /**
+     * @return true if a record was copied into `item`, or false if the queue
+     * was empty.
+     */
+    bool try_pop(T& item) noexcept {
+        const T* slot = try_peek();
+        if (!slot) {
+            return false;
+        }
+        item = *slot;
+        release();
+        return true;
+    }
+
+    /**
+     * @brief Pops the oldest record, sleeping while the queue is empty.
+     */
+    T pop() noexcept {
+        T item = *peek();
+        release();
+        return item;
+    }
+
+    /**
+     * @brief Hands up to `max` records at the front of the queue to `fn` in
+     * place, then releases them all at once.
+     *
+     * `fn(begin, end)` is called once for each of the at most two contiguous
+     * spans of ready records, oldest first. The head counter is published,
+     * and the producer woken if it is waiting, once for the whole batch. If
+     * `fn` throws, the spans it already returned from are released.
+     *
+     * @param max Maximum number of records to consume.
+     * @param fn Callable as `fn(const T* begin, const T* end)`.
+     * @return Number of records consumed. Zero if the queue was empty.
+     */
+    template <class Fn>
+    std::size_t consume_batch(std::size_t max, Fn&& fn) {
+        const std::uint32_t head =
+            header_->head.load(std::memory_order_relaxed);
+        tail_cache_ = header_->tail.load(std::memory_order_acquire);
+        const std::size_t count =
+            std::min<std::size_t>(tail_cache_ - head, max);
+        if (count == 0) {
+            return 0;
+        }
+        const std::size_t index = head & (capacity_ - 1);
+        const std::size_t first = std::min(count, capacity_ - index);
+        const T* data = data_;
+        fn(data + index, data + index + first);
+        if (first < count) {
+            try {
+                fn(data, data + (count - first));
+            } catch (...) {
+                release(first);
+                throw;
+            }
+        }
+        release(count);
+        return count;
+    }
+
+    /**
+     * @} End of Consumer functions
+     */
+
+  private:
+    void wait_while_full() noexcept {
+        detail::shm_spsc_header& header = *header_;
+        header.producer_waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::uint32_t head = header.head.load(std::memory_order_acquire);
+        if (header.tail.load(std::memory_order_relaxed) - head == capacity_) {
+            detail::futex_wait(header.head, head);
+        }
+        header.producer_waiting.store(0, std::memory_order_relaxed);
+    }
+
+    void wait_while_empty() noexcept {
+        detail::shm_spsc_header& header = *header_;
+        header.consumer_waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::uint32_t tail = header.tail.load(std::memory_order_acquire);
+        if (header.head.load(std::memory_order_relaxed) == tail) {
+            detail::futex_wait(header.tail, tail);
+        }
+        header.consumer_waiting.store(0, std::memory_order_relaxed);
+    }
+
+    // Slots start on their own cache line, after the control block.
+    static constexpr std::size_t slots_offset() noexcept {
+        constexpr std::size_t align = alignof(T) > detail::cache_line_size
+                                          ? alignof(T)
+                                          : detail::cache_line_size;
+        return (sizeof(detail::shm_spsc_header) + align - 1) / align * align;
+    }
+
+    std::size_t segment_size() const noexcept {
+        return slots_offset() + capacity_ * sizeof(T);
+    }
+
+    // Maps the segment and closes `fd`.
+    void map(int fd) {
+        void* base = ::mmap(nullptr, segment_size(), PROT_READ | PROT_WRITE,
+                            MAP_SHARED, fd, 0);
+        int err = errno;
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            throw_system_error("mmap", err);
+        }
+        header_ = static_cast<detail::shm_spsc_header*>(base);
+        data_ = reinterpret_cast<T*>(static_cast<unsigned char*>(base) +
+                                     slots_offset());
+    }
+
+    [[noreturn]] static void throw_system_error(const char* what,
+                                                int err = errno) {
+        throw std::system_error{err, std::system_category(), what};
+    }
+
+    detail::shm_spsc_header* header_{nullptr};
+    T* data_{nullptr};
+    std::size_t capacity_{0};
+
+    // Private copies of the other side's counter. A handle is used by either
+    // the producer or the consumer, so only one of these is in use.
+    std::uint32_t head_cache_{0};
+    std::uint32_t tail_cache_{0};
+};
+
+} // namespace samwarring
+
+#endif
+
+#endif
@@ -0,0 +1,767 @@
+#ifndef INCLUDED_SAMWARRING_SIMD_KERNELS_HPP
+#define INCLUDED_SAMWARRING_SIMD_KERNELS_HPP
+
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <samwarring/ring_buffer.hpp>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SAMWARRING_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#else
+#define SAMWARRING_SIMD_X86 0
+#endif
+
+// GCC and Clang only allow AVX2 intrinsics inside functions compiled for
+// AVX2. MSVC allows them anywhere.
+#if defined(__GNUC__) || defined(__clang__)
+#define SAMWARRING_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SAMWARRING_TARGET_AVX2
+#endif
+
+namespace samwarring {
+
+/**
+ * @brief Reduction kernels over contiguous arrays and ring buffer windows.
+ *
+ * Iterating a @ref ring_buffer with its ordered iterator checks for
+ * wraparound on every element, which keeps compilers from vectorizing the
+ * loop. The kernels in this namespace instead run over the (at most) two
+ * contiguous spans given by ring_buffer::first_part and
+ * ring_buffer::second_part. The same overloads accept a @ref soa_column, or
+ * any other window with those two functions.
+ *
+ * Kernels for `float`, `double` and `std::int32_t` are vectorized with SSE2
+ * or AVX2 on x86-64. The instruction set is chosen at run time, on first
+ * use, from what the CPU supports. Other element types, and other
+ * architectures, use scalar loops.
+ *
+ * Vectorized floating-point sums add elements in a different order than a
+ * scalar loop, so their results may differ in the last few bits.
+ *
+ * Integer sums and dot products are accumulated in 64 bits.
+ */
+namespace simd {
+
+/**
+ * @brief Type returned by sum and dot for elements of type T.
+ */
+template <class T>
+using accumulator_t =
+    std::conditional_t<std::is_floating_point_v<T>, T,
+                       std::conditional_t<std::is_signed_v<T>, std::int64_t,
+                                          std::uint64_t>>;
+
+/**
+ * @brief Instruction sets that kernels can be dispatched to.
+ */
+enum class instruction_set { scalar, sse2, avx2 };
+
+/**
+ * @brief Returns the best instruction set supported by this CPU.
+ *
+ * The CPU is queried once; later calls return the cached result.
+ */
+inline instruction_set best_instruction_set() noexcept {
+    static const instruction_set best = [] {
+#if SAMWARRING_SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool ymm_enabled = osxsave && (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(info, 7, 0);
+        if (ymm_enabled && (info[1] & (1 << 5))) {
+            return instruction_set::avx2;
+        }
+#else
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return instruction_set::avx2;
+        }
+#endif
+        // SSE2 is part of the x86-64 baseline.
+        return instruction_set::sse2;
+#else
+        return instruction_set::scalar;
+#endif
+    }();
+    return best;
+}
+
+namespace detail {
+
+namespace scalar {
+
+template <class T>
+accumulator_t<T> sum(const T* data, std::size_t n) noexcept {
+    accumulator_t<T> total{0};
+    for (std::size_t i = 0; i < n; ++i) {
+        total += data[i];
+    }
+    return total;
+}
+
+template <class T>
+std::pair<T, T> min_max(const T* data, std::size_t n) noexcept {
+    T lo = data[0];
+    T hi = data[0];
+    for (std::size_t i = 1; i < n; ++i) {
+        lo = std::min(lo, data[i]);
+        hi = std::max(hi, data[i]);
+    }
+    return {lo, hi};
+}
+
+template <class T>
+accumulator_t<T> dot(const T* data, const T* kernel, std::size_t n) noexcept {
+    accumulator_t<T> total{0};
+    for (std::size_t i = 0; i < n; ++i) {
+        total += static_cast<accumulator_t<T>>(data[i]) *
+                 static_cast<accumulator_t<T>>(kernel[i]);
+    }
+    return total;
+}
+
+template <class T>
+std::size_t count_greater(const T* data, std::size_t n, T threshold) noexcept {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        count += data[i] > threshold;
+    }
+    return count;
+}
+
+} // namespace scalar
+
+#if SAMWARRING_SIMD_X86
+
+inline std::size_t popcount(unsigned mask) noexcept {
+    return std::bitset<32>(mask).count();
+}
+
+namespace sse2 {
+
+inline float sum(const float* data, std::size_t n) noexcept {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_loadu_ps(data + i));
+        acc1 = _mm_add_ps(acc1, _mm_loadu_ps(data + i + 4));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) +
+           scalar::sum(data + i, n - i);
+}
+
+inline double sum(const double* data, std::size_t n) noexcept {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_loadu_pd(data + i));
+        acc1 = _mm_add_pd(acc1, _mm_loadu_pd(data + i + 2));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(acc0, acc1));
+    return lanes[0] + lanes[1] + scalar::sum(data + i, n - i);
+}
+
+inline std::int64_t sum(const std::int32_t* data, std::size_t n) noexcept {
+    __m128i acc = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        // Sign-extend four 32-bit lanes into two pairs of 64-bit lanes.
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i sign = _mm_srai_epi32(v, 31);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+    }
+    alignas(16) std::int64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return lanes[0] + lanes[1] + scalar::sum(data + i, n - i);
+}
+
+inline std::pair<float, float> min_max(const float* data,
+                                       std::size_t n) noexcept {
+    if (n < 4) {
+        return scalar::min_max(data, n);
+    }
+    __m128 lo = _mm_loadu_ps(data);
+    __m128 hi = lo;
+    std::size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(data + i);
+        lo = _mm_min_ps(lo, v);
+        hi = _mm_max_ps(hi, v);
+    }
+    alignas(16) float lo_lanes[4];
+    alignas(16) float hi_lanes[4];
+    _mm_store_ps(lo_lanes, lo);
+    _mm_store_ps(hi_lanes, hi);
+    auto result = scalar::min_max(lo_lanes, 4);
+    result.second = scalar::min_max(hi_lanes, 4).second;
+    for (; i < n; ++i) {
+        result.first = std::min(result.first, data[i]);
+        result.second = std::max(result.second, data[i]);
+    }
+    return result;
+}
+
+inline std::pair<double, double> min_max(const double* data,
+                                         std::size_t n) noexcept {
+    if (n < 2) {
+        return scalar::min_max(data, n);
+    }
+    __m128d lo = _mm_loadu_pd(data);
+    __m128d hi = lo;
+    std::size_t i = 2;
+    for (; i + 2 <= n; i += 2) {
+        __m128d v = _mm_loadu_pd(data + i);
+        lo = _mm_min_pd(lo, v);
+        hi = _mm_max_pd(hi, v);
+    }
+    alignas(16) double lo_lanes[2];
+    alignas(16) double hi_lanes[2];
+    _mm_store_pd(lo_lanes, lo);
+    _mm_store_pd(hi_lanes, hi);
+    std::pair<double, double> result{std::min(lo_lanes[0], lo_lanes[1]),
+                                     std::max(hi_lanes[0], hi_lanes[1])};
+    for (; i < n; ++i) {
+        result.first = std::min(result.first, data[i]);
+        result.second = std::max(result.second, data[i]);
+    }
+    return result;
+}
+
+inline std::pair<std::int32_t, std::int32_t>
+min_max(const std::int32_t* data, std::size_t n) noexcept {
+    if (n < 4) {
+        return scalar::min_max(data, n);
+    }
+    // SSE2 has no 32-bit min/max, so select lanes with a comparison mask.
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    __m128i hi = lo;
+    std::size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i lo_gt = _mm_cmpgt_epi32(lo, v);
+        lo = _mm_or_si128(_mm_and_si128(lo_gt, v), _mm_andnot_si128(lo_gt, lo));
+        __m128i v_gt = _mm_cmpgt_epi32(v, hi);
+        hi = _mm_or_si128(_mm_and_si128(v_gt, v), _mm_andnot_si128(v_gt, hi));
+    }
+    alignas(16) std::int32_t lo_lanes[4];
+    alignas(16) std::int32_t hi_lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lo_lanes), lo);
+    _mm_store_si128(reinterpret_cast<__m128i*>(hi_lanes), hi);
+    auto result = scalar::min_max(lo_lanes, 4);
+    result.second = scalar::min_max(hi_lanes, 4).second;
+    for (; i < n; ++i) {
+        result.first = std::min(result.first, data[i]);
+        result.second = std::max(result.second, data[i]);
+    }
+    return result;
+}
+
+inline float dot(const float* data, const float* kernel,
+                 std::size_t n) noexcept {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(data + i),
+                                           _mm_loadu_ps(kernel + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(data + i + 4),
+                                           _mm_loadu_ps(kernel + i + 4)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) +
+           scalar::dot(data + i, kernel + i, n - i);
+}
+
+inline double dot(const double* data, const double* kernel,
+                  std::size_t n) noexcept {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(data + i),
+                                           _mm_loadu_pd(kernel + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(data + i + 2),
+                                           _mm_loadu_pd(kernel + i + 2)));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(acc0, acc1));
+    return lanes[0] + lanes[1] + scalar::dot(data + i, kernel + i, n - i);
+}
+
+// SSE2 has no signed 32x32->64-bit multiply, so the int32 dot product stays
+// scalar unless AVX2 is available.
+inline std::int64_t dot(const std::int32_t* data, const std::int32_t* kernel,
+                        std::size_t n) noexcept {
+    return scalar::dot(data, kernel, n);
+}
+
+inline std::size_t count_greater(const float* data, std::size_t n,
+                                 float threshold) noexcept {
+    const __m128 t = _mm_set1_ps(threshold);
+    std::size_t count = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        count += popcount(static_cast<unsigned>(
+            _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(data + i), t))));
+    }
+    return count + scalar::count_greater(data + i, n - i, threshold);
+}
+
+inline std::size_t count_greater(const double* data, std::size_t n,
+                                 double threshold) noexcept {
+    const __m128d t = _mm_set1_pd(threshold);
+    std::size_t count = 0;
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        count += popcount(static_cast<unsigned>(
+            _mm_movemask_pd(_mm_cmpgt_pd(_mm_loadu_pd(data + i), t))));
+    }
+    return count + scalar::count_greater(data + i, n - i, threshold);
+}
+
+inline std::size_t count_greater(const std::int32_t* data, std::size_t n,
+                                 std::int32_t threshold) noexcept {
+    const __m128i t = _mm_set1_epi32(threshold);
+    std::size_t count = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        count += popcount(static_cast<unsigned>(
+            _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, t)))));
+    }
+    return count + scalar::count_greater(data + i, n - i, threshold);
+}
+
+} // namespace sse2
+
+namespace avx2 {
+
+SAMWARRING_TARGET_AVX2
+inline float sum(const float* data, std::size_t n) noexcept {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(data + i));
+        acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(data + i + 8));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, _mm256_add_ps(acc0, acc1));
+    float total = 0;
+    for (float lane : lanes) {
+        total += lane;
+    }
+    return total + scalar::sum(data + i, n - i);
+}
+
+SAMWARRING_TARGET_AVX2
+inline double sum(const double* data, std::size_t n) noexcept {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(data + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(data + i + 4));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) +
+           scalar::sum(data + i, n - i);
+}
+
+SAMWARRING_TARGET_AVX2
+inline std::int64_t sum(const std::int32_t* data, std::size_t n) noexcept {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_epi64(
+            acc0, _mm256_cvtepi32_epi64(_mm_loadu_si128(
+                      reinterpret_cast<const __m128i*>(data + i))));
+        acc1 = _mm256_add_epi64(
+            acc1, _mm256_cvtepi32_epi64(_mm_loadu_si128(
+                      reinterpret_cast<const __m128i*>(data + i + 4))));
+    }
+    alignas(32) std::int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes),
+                       _mm256_add_epi64(acc0, acc1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) +
+           scalar::sum(data + i, n - i);
+}
+
+SAMWARRING_TARGET_AVX2
+inline std::pair<float, float> min_max(const float* data,
+                                       std::size_t n) noexcept {
+    if (n < 8) {
+        return scalar::min_max(data, n);
+    }
+    __m256 lo = _mm256_loadu_ps(data);
+    __m256 hi = lo;
+    std::size_t i = 8;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(data + i);
+        lo = _mm256_min_ps(lo, v);
+        hi = _mm256_max_ps(hi, v);
+    }
+    alignas(32) float lo_lanes[8];
+    alignas(32) float hi_lanes[8];
+    _mm256_store_ps(lo_lanes, lo);
+    _mm256_store_ps(hi_lanes, hi);
+    auto result = scalar::min_max(lo_lanes, 8);
+    result.second = scalar::min_max(hi_lanes, 8).second;
+    for (; i < n; ++i) {
+        result.first = std::min(result.first, data[i]);
+        result.second = std::max(result.second, data[i]);
+    }
+    return result;
+}
+
+SAMWARRING_TARGET_AVX2
+inline std::pair<double, double> min_max(const double* data,
+                                         std::size_t n) noexcept {
+    if (n < 4) {
+        return scalar::min_max(data, n);
+    }
+    __m256d lo = _mm256_loadu_pd(data);
+    __m256d hi = lo;
+    std::size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(data + i);
+        lo = _mm256_min_pd(lo, v);
+        hi = _mm256_max_pd(hi, v);
+    }
+    alignas(32) double lo_lanes[4];
+    alignas(32) double hi_lanes[4];
+    _mm256_store_pd(lo_lanes, lo);
+    _mm256_store_pd(hi_lanes, hi);
+    auto result = scalar::min_max(lo_lanes, 4);
+    result.second = scalar::min_max(hi_lanes, 4).second;
+    for (; i < n; ++i) {
+        result.first = std::min(result.first, data[i]);
+        result.second = std::max(result.second, data[i]);
+    }
+    return result;
+}
+
+SAMWARRING_TARGET_AVX2
+inline std::pair<std::int32_t, std::int32_t>
+min_max(const std::int32_t* data, std::size_t n) noexcept {
+    if (n < 8) {
+        return scalar::min_max(data, n);
+    }
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    __m256i hi = lo;
+    std::size_t i = 8;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        lo = _mm256_min_epi32(lo, v);
+        hi = _mm256_max_epi32(hi, v);
+    }
+    alignas(32) std::int32_t lo_lanes[8];
+    alignas(32) std::int32_t hi_lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lo_lanes), lo);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(hi_lanes), hi);
+    auto result = scalar::min_max(lo_lanes, 8);
+    result.second = scalar::min_max(hi_lanes, 8).second;
+    for (; i < n; ++i) {
+        result.first = std::min(result.first, data[i]);
+        result.second = std::max(result.second, data[i]);
+    }
+    return result;
+}
+
+SAMWARRING_TARGET_AVX2
+inline float dot(const float* data, const float* kernel,
+                 std::size_t n) noexcept {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(data + i),
+                                                 _mm256_loadu_ps(kernel + i)));
+        acc1 = _mm256_add_ps(acc1,
+                             _mm256_mul_ps(_mm256_loadu_ps(data + i + 8),
+                                           _mm256_loadu_ps(kernel + i + 8)));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, _mm256_add_ps(acc0, acc1));
+    float total = 0;
+    for (float lane : lanes) {
+        total += lane;
+    }
+    return total + scalar::dot(data + i, kernel + i, n - i);
+}
+
+SAMWARRING_TARGET_AVX2
+inline double dot(const double* data, const double* kernel,
+                  std::size_t n) noexcept {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(data + i),
+                                                 _mm256_loadu_pd(kernel + i)));
+        acc1 = _mm256_add_pd(acc1,
+                             _mm256_mul_pd(_mm256_loadu_pd(data + i + 4),
+                                           _mm256_loadu_pd(kernel + i + 4)));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) +
+           scalar::dot(data + i, kernel + i, n - i);
+}
+
+SAMWARRING_TARGET_AVX2
+inline std::int64_t dot(const std::int32_t* data, const std::int32_t* kernel,
+                        std::size_t n) noexcept {
+    // Sign-extend four lanes at a time to 64 bits; _mm256_mul_epi32 then
+    // multiplies the low 32 bits of each 64-bit lane into a 64-bit product.
+    __m256i acc = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i a = _mm256_cvtepi32_epi64(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+        __m256i b = _mm256_cvtepi32_epi64(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(kernel + i)));
+        acc = _mm256_add_epi64(acc, _mm256_mul_epi32(a, b));
+    }
+    alignas(32) std::int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) +
+           scalar::dot(data + i, kernel + i, n - i);
+}
+
+SAMWARRING_TARGET_AVX2
+inline std::size_t count_greater(const float* data, std::size_t n,
+                                 float threshold) noexcept {
+    const __m256 t = _mm256_set1_ps(threshold);
+    std::size_t count = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        count += popcount(static_cast<unsigned>(_mm256_movemask_ps(
+            _mm256_cmp_ps(_mm256_loadu_ps(data + i), t, _CMP_GT_OQ))));
+    }
+    return count + scalar::count_greater(data + i, n - i, threshold);
+}
+
+SAMWARRING_TARGET_AVX2
+inline std::size_t count_greater(const double* data, std::size_t n,
+                                 double threshold) noexcept {
+    const __m256d t = _mm256_set1_pd(threshold);
+    std::size_t count = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        count += popcount(static_cast<unsigned>(_mm256_movemask_pd(
+            _mm256_cmp_pd(_mm256_loadu_pd(data + i), t, _CMP_GT_OQ))));
+    }
+    return count + scalar::count_greater(data + i, n - i, threshold);
+}
+
+SAMWARRING_TARGET_AVX2
+inline std::size_t count_greater(const std::int32_t* data, std::size_t n,
+                                 std::int32_t threshold) noexcept {
+    const __m256i t = _mm256_set1_epi32(threshold);
+    std::size_t count = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        count += popcount(static_cast<unsigned>(_mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(v, t)))));
+    }
+    return count + scalar::count_greater(data + i, n - i, threshold);
+}
+
+} // namespace avx2
+
+#endif
+
+// Element types with vectorized kernels.
+template <class T>
+inline constexpr bool is_vectorized_v =
+    std::is_same_v<T, float> || std::is_same_v<T, double> ||
+    std::is_same_v<T, std::int32_t>;
+
+// Item type of a window, deduced from the spans of its first_part().
+template <class Window>
+using window_value_t = std::remove_const_t<std::remove_pointer_t<
+    decltype(std::declval<const Window&>().first_part().begin())>>;
+
+template <class Window>
+using window_accumulator_t = accumulator_t<window_value_t<Window>>;
+
+} // namespace detail
+
+/**
+ * @brief Returns the sum of `n` elements.
+ */
+template <class T>
+accumulator_t<T> sum(const T* data, std::size_t n) noexcept {
+#if SAMWARRING_SIMD_X86
+    if constexpr (detail::is_vectorized_v<T>) {
+        switch (best_instruction_set()) {
+        case instruction_set::avx2:
+            return detail::avx2::sum(data, n);
+        case instruction_set::sse2:
+            return detail::sse2::sum(data, n);
+        case instruction_set::scalar:
+            break;
+        }
+    }
+#endif
+    return detail::scalar::sum(data, n);
+}
+
+/**
+ * @brief Returns the smallest and largest of `n` elements. `n` must be
+ * non-zero.
+ */
+template <class T>
+std::pair<T, T> min_max(const T* data, std::size_t n) noexcept {
+#if SAMWARRING_SIMD_X86
+    if constexpr (detail::is_vectorized_v<T>) {
+        switch (best_instruction_set()) {
+        case instruction_set::avx2:
+            return detail::avx2::min_max(data, n);
+        case instruction_set::sse2:
+            return detail::sse2::min_max(data, n);
+        case instruction_set::scalar:
+            break;
+        }
+    }
+#endif
+    return detail::scalar::min_max(data, n);
+}
+
+/**
+ * @brief Returns the dot product of `n` elements with `n` kernel taps.
+ */
+template <class T>
+accumulator_t<T> dot(const T* data, const T* kernel, std::size_t n) noexcept {
+#if SAMWARRING_SIMD_X86
+    if constexpr (detail::is_vectorized_v<T>) {
+        switch (best_instruction_set()) {
+        case instruction_set::avx2:
+            return detail::avx2::dot(data, kernel, n);
+        case instruction_set::sse2:
+            return detail::sse2::dot(data, kernel, n);
+        case instruction_set::scalar:
+            break;
+        }
+    }
+#endif
+    return detail::scalar::dot(data, kernel, n);
+}
+
+/**
+ * @brief Returns how many of `n` elements are greater than `threshold`.
+ */
+template <class T>
+std::size_t count_greater(const T* data, std::size_t n, T threshold) noexcept {
+#if SAMWARRING_SIMD_X86
+    if constexpr (detail::is_vectorized_v<T>) {
+        switch (best_instruction_set()) {
+        case instruction_set::avx2:
+            return detail::avx2::count_greater(data, n, threshold);
+        case instruction_set::sse2:
+            return detail::sse2::count_greater(data, n, threshold);
+        case instruction_set::scalar:
+            break;
+        }
+    }
+#endif
+    return detail::scalar::count_greater(data, n, threshold);
+}
+
+/**
+ * @brief Returns the sum of all items in a window.
+ *
+ * A window is a @ref ring_buffer, a @ref soa_column, or any other type whose
+ * first_part() and second_part() return contiguous spans.
+ */
+template <class Window>
+detail::window_accumulator_t<Window> sum(const Window& window) noexcept {
+    auto first = window.first_part();
+    auto second = window.second_part();
+    return sum(first.begin(), first.end() - first.begin()) +
+           sum(second.begin(), second.end() - second.begin());
+}
+
+/**
+ * @brief Returns the smallest and largest items in a window. The window must
+ * not be empty.
+ */
+template <class Window>
+std::pair<detail::window_value_t<Window>, detail::window_value_t<Window>>
+min_max(const Window& window) noexcept {
+    auto first = window.first_part();
+    auto second = window.second_part();
+    const std::size_t n1 = first.end() - first.begin();
+    const std::size_t n2 = second.end() - second.begin();
+    if (n1 == 0) {
+        return min_max(second.begin(), n2);
+    }
+    auto result = min_max(first.begin(), n1);
+    if (n2 != 0) {
+        auto rest = min_max(second.begin(), n2);
+        result.first = std::min(result.first, rest.first);
+        result.second = std::max(result.second, rest.second);
+    }
+    return result;
+}
+
+/**
+ * @brief Returns the dot product of a window with a filter kernel.
+ *
+ * Kernel taps are matched with items in order from front to back: `kernel[0]`
+ * multiplies the front item, and so on. The kernel must have at least as many
+ * taps as the window has items.
+ */
+template <class Window>
+detail::window_accumulator_t<Window>
+dot(const Window& window,
+    const detail::window_value_t<Window>* kernel) noexcept {
+    auto first = window.first_part();
+    auto second = window.second_part();
+    const std::size_t n1 = first.end() - first.begin();
+    return dot(first.begin(), kernel, n1) +
+           dot(second.begin(), kernel + n1, second.end() - second.begin());
+}
+
+/**
+ * @brief Returns how many items in a window are greater than `threshold`.
+ */
+template <class Window>
+std::size_t count_greater(const Window& window,
+                          detail::window_value_t<Window> threshold) noexcept {
+    auto first = window.first_part();
+    auto second = window.second_part();
+    return count_greater(first.begin(), first.end() - first.begin(),
+                         threshold) +
+           count_greater(second.begin(), second.end() - second.begin(),
+                         threshold);
+}
+
+} // namespace simd
+} // namespace samwarring
+
+#endif
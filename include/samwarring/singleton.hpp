@@ -1,9 +1,16 @@
 #ifndef INCLUDED_SAMWARRING_SINGLETON_HPP
 #define INCLUDED_SAMWARRING_SINGLETON_HPP
 
-#include <atomic>
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
 #include <memory>
 #include <mutex>
+#include <samwarring/detail/cache_line.hpp>
+#include <samwarring/detail/thread_ordinal.hpp>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
 namespace samwarring {
 
@@ -50,6 +57,40 @@ T& singleton() {
     return instance;
 }
 
+namespace detail {
+
+// Shared state of one reference_counted_singleton<T, Tag>.
+template <class T, class Tag>
+struct reference_counted_singleton_state {
+    static reference_counted_singleton_state& get() {
+        static reference_counted_singleton_state state;
+        return state;
+    }
+
+    // Destroys the object, and then lets the next one be constructed.
+    struct deleter {
+        void operator()(T* ptr) const {
+            delete ptr;
+            auto& state = get();
+            {
+                std::lock_guard<std::mutex> lk{state.mtx};
+                state.deleted = true;
+            }
+            state.destroyed_cv.notify_all();
+        }
+    };
+
+    std::mutex mtx;
+    std::condition_variable destroyed_cv;
+    std::weak_ptr<T> instance;
+
+    // Set to false when an object is constructed, and back to true *after*
+    // the instance has been destroyed. Guarded by `mtx`.
+    bool deleted{true};
+};
+
+} // namespace detail
+
 /**
  * @brief Returns a shared reference-counted singleton object.
  *
@@ -59,14 +100,19 @@ T& singleton() {
  *
  * Once all shared pointers are destroyed, the singleton object is destroyed as
  * well. Any following call will construct a new singleton object with its
- * default constructor.
+ * default constructor. The new object is not constructed until the old one
+ * has finished being destroyed.
  *
  * If a program wants to use multiple singletons of the same type, it can
  * distinguish between them using the `Tag` template parameter. Calls that use
  * the same type for `Tag` will retrieve the same instance. Calls using
  * different types for `Tag` will retrieve different instances.
  *
- * This function is thread-safe.
+ * This function is thread-safe. While the object is alive, a call takes no
+ * lock: each thread caches a weak pointer to the object, and promotes it with
+ * one atomic increment of the reference count. A mutex is only taken when
+ * the thread's cached pointer has expired, which is when the object is
+ * constructed, or on a thread's first call after the object was destroyed.
  *
  * @tparam T The type of singleton object. Must be default-constructable.
  * @tparam Tag Distinguishes between different singletons of the same type.
@@ -76,34 +122,271 @@ template <class T, class Tag = default_singleton_tag>
 std::shared_ptr<T> reference_counted_singleton() {
     static_assert(std::is_default_constructible_v<T>,
                   "Singleton type is not default constructable");
+    using state_type = detail::reference_counted_singleton_state<T, Tag>;
 
-    static std::weak_ptr<T> instance;
-    static std::mutex mtx;
-
-    // Will set to false when an object is being constructed, and back to true
-    // *after* the instance has been destroyed.
-    static std::atomic<bool> deleted{true};
+    // An expired pointer never becomes valid again, so a cached pointer that
+    // can be promoted always refers to the current object.
+    thread_local std::weak_ptr<T> cached;
+    if (std::shared_ptr<T> shared = cached.lock()) {
+        return shared;
+    }
 
-    std::unique_lock<std::mutex> lk{mtx};
-    std::shared_ptr<T> shared = instance.lock();
+    state_type& state = state_type::get();
+    std::unique_lock<std::mutex> lk{state.mtx};
+    std::shared_ptr<T> shared = state.instance.lock();
     if (!shared) {
         // The refcount is 0, but has the object actually been destroyed yet?
-        // Spin until it is.
-        bool expected;
-        do {
-            expected = true;
-        } while (!deleted.compare_exchange_weak(expected, false));
-
-        deleted.store(false);
-        shared = std::shared_ptr<T>(new T{}, [&](T* ptr) {
-            delete ptr;
-            deleted.store(true);
-        });
-        instance = shared;
+        // Wait until it is.
+        state.destroyed_cv.wait(lk, [&] { return state.deleted; });
+
+        // If the shared pointer cannot be constructed, `owned` keeps the
+        // object, and it is destroyed without the deleter, which would take
+        // the mutex again.
+        std::unique_ptr<T, typename state_type::deleter> owned{new T{}};
+        try {
+            shared = std::move(owned);
+        } catch (...) {
+            delete owned.release();
+            throw;
+        }
+        state.deleted = false;
+        state.instance = shared;
     }
+    lk.unlock();
+    cached = shared;
     return shared;
 }
 
+namespace detail {
+
+// One thread's reference to a reference_counted_singleton<T, Tag>, shared by
+// every borrowed_singleton<T, Tag> on that thread.
+template <class T, class Tag>
+struct borrowed_singleton_cache {
+    static borrowed_singleton_cache& local() {
+        thread_local borrowed_singleton_cache cache;
+        return cache;
+    }
+
+    std::shared_ptr<T> strong;
+    std::size_t borrows{0};
+    bool release_pending{false};
+};
+
+} // namespace detail
+
+/**
+ * @brief Handle to a @ref reference_counted_singleton object, borrowed from
+ * the calling thread's own reference.
+ *
+ * Copying a std::shared_ptr writes the reference count in the shared control
+ * block, so threads that fetch the singleton over and over keep stealing that
+ * cache line from each other. A borrowed_singleton avoids this. The first
+ * handle on a thread takes one shared reference and caches it in a
+ * thread-local. Every later handle on that thread, and every copy of one,
+ * only increments a counter private to the thread.
+ *
+ * The thread keeps its reference even once its handles are gone, so that
+ * borrowing again is just as cheap. It is dropped when the thread exits, or
+ * when the thread calls release_thread_reference() and its handles are gone.
+ * The object is therefore only destroyed once every thread that borrowed it
+ * has exited or released its reference, and every shared_ptr from
+ * reference_counted_singleton is gone.
+ *
+ * A handle must be destroyed on the thread that borrowed it. To share the
+ * object with another thread, that thread borrows its own handle, or takes a
+ * std::shared_ptr with reference_counted_singleton.
+ *
+ * Example
+ * -------
+ *
+ *      void on_request(const request& r) {
+ *          borrowed_singleton<metrics> m;
+ *          m->requests.add(1);
+ *      }
+ *
+ * @tparam T The type of singleton object. Must be default-constructable.
+ * @tparam Tag Distinguishes between different singletons of the same type.
+ */
+template <class T, class Tag = default_singleton_tag>
+class borrowed_singleton {
+    using cache_type = detail::borrowed_singleton_cache<T, Tag>;
+
+  public:
+    /**
+     * @brief Borrows the singleton object on the calling thread, constructing
+     * it if needed.
+     */
+    borrowed_singleton() : cache_{&cache_type::local()} {
+        if (!cache_->strong) {
+            cache_->strong = reference_counted_singleton<T, Tag>();
+        }
+        ptr_ = cache_->strong.get();
+        ++cache_->borrows;
+    }
+
+    borrowed_singleton(const borrowed_singleton& other) noexcept
+        : cache_{other.cache_}, ptr_{other.ptr_} {
+        ++cache_->borrows;
+    }
+
+    borrowed_singleton& operator=(const borrowed_singleton&) = delete;
+
+    ~borrowed_singleton() {
+        if (--cache_->borrows == 0 && cache_->release_pending) {
+            cache_->release_pending = false;
+            cache_->strong.reset();
+        }
+    }
+
+    T& operator*() const noexcept {
+        return *ptr_;
+    }
+
+    T* operator->() const noexcept {
+        return ptr_;
+    }
+
+    T* get() const noexcept {
+        return ptr_;
+    }
+
+    /**
+     * @brief Drops the calling thread's reference to the object, once the
+     * thread has no handles left.
+     *
+     * If the thread still has handles, the reference is dropped when the
+     * last of them is destroyed.
+     */
+    static void release_thread_reference() {
+        cache_type& cache = cache_type::local();
+        if (cache.borrows == 0) {
+            cache.strong.reset();
+        } else {
+            cache.release_pending = true;
+        }
+    }
+
+  private:
+    cache_type* cache_;
+    T* ptr_;
+};
+
+/**
+ * @brief Singleton with one instance of a type per shard, for state that is
+ * written far more often than it is read.
+ *
+ * Counters, statistics and caches that every request writes to are slow as a
+ * single @ref singleton, because every core keeps stealing the object's cache
+ * lines from every other core. A sharded_singleton keeps one default
+ * constructed `T` per shard instead, each on its own cache lines. There is
+ * one shard per hardware thread.
+ *
+ * Writers update their own shard through local(). Threads are assigned to
+ * shards round-robin, in the order they first use any sharded type, so until
+ * there are more threads than hardware threads, each thread has a shard to
+ * itself. Readers visit every shard with for_each() or fold them into one
+ * value with combine().
+ *
+ * Shards may be read while their writers are updating them, and two threads
+ * may share a shard, so `T` must be safe to use concurrently, for example by
+ * holding std::atomic members. Writers that have a shard to themselves only
+ * ever touch their own cache lines, so even their atomic updates are
+ * uncontended.
+ *
+ * Like @ref singleton, the shards live for the duration of the program, and
+ * different `Tag` types give different sets of shards.
+ *
+ * Example
+ * -------
+ *
+ *      struct request_counter {
+ *          std::atomic<std::uint64_t> count{0};
+ *      };
+ *
+ *      // On every request
+ *      sharded_singleton<request_counter>::local().count.fetch_add(
+ *          1, std::memory_order_relaxed);
+ *
+ *      // In the metrics reporter
+ *      auto total = sharded_singleton<request_counter>::combine(
+ *          std::uint64_t{0}, [](std::uint64_t sum, const request_counter& c) {
+ *              return sum + c.count.load(std::memory_order_relaxed);
+ *          });
+ *
+ * @tparam T The type of each shard. Must be default-constructable.
+ * @tparam Tag Distinguishes between different singletons of the same type.
+ */
+template <class T, class Tag = default_singleton_tag>
+class sharded_singleton {
+    static_assert(std::is_default_constructible_v<T>,
+                  "Singleton type is not default constructable");
+
+  public:
+    sharded_singleton() = delete;
+
+    /**
+     * @return The calling thread's shard.
+     */
+    static T& local() noexcept {
+        thread_local T& mine =
+            shards().data[detail::this_thread_ordinal() % shards().count]
+                .value;
+        return mine;
+    }
+
+    /**
+     * @brief Calls `fn(T&)` for every shard.
+     */
+    template <class Fn>
+    static void for_each(Fn fn) {
+        storage& s = shards();
+        for (std::size_t i = 0; i < s.count; ++i) {
+            fn(s.data[i].value);
+        }
+    }
+
+    /**
+     * @brief Folds every shard into one value.
+     *
+     * @param init Initial value of the result.
+     * @param op Called as `result = op(std::move(result), shard)` for every
+     * shard.
+     * @return The final value of the result.
+     */
+    template <class R, class Op>
+    static R combine(R init, Op op) {
+        for_each([&](T& shard) { init = op(std::move(init), shard); });
+        return init;
+    }
+
+    /**
+     * @return Number of shards.
+     */
+    static std::size_t shard_count() {
+        return shards().count;
+    }
+
+  private:
+    struct alignas(detail::cache_line_size) shard {
+        T value{};
+    };
+
+    struct storage {
+        storage()
+            : count{std::max(1u, std::thread::hardware_concurrency())},
+              data{new shard[count]} {}
+
+        std::size_t count;
+        std::unique_ptr<shard[]> data;
+    };
+
+    static storage& shards() {
+        static storage s;
+        return s;
+    }
+};
+
 } // namespace samwarring
 
 #endif
\ No newline at end of file
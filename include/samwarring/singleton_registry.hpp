@@ -0,0 +1,320 @@
+#ifndef INCLUDED_SAMWARRING_SINGLETON_REGISTRY_HPP
+#define INCLUDED_SAMWARRING_SINGLETON_REGISTRY_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <samwarring/singleton.hpp>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace samwarring {
+
+namespace detail {
+
+// The object constructed by a singleton_registry for T and Tag, or nullptr.
+template <class T, class Tag>
+inline T* registered_singleton = nullptr;
+
+} // namespace detail
+
+/**
+ * @brief Names a singleton registered with a @ref singleton_registry, as a
+ * dependency of another.
+ *
+ * @tparam T The type of singleton object.
+ * @tparam Tag Distinguishes between different singletons of the same type.
+ */
+template <class T, class Tag = default_singleton_tag>
+struct singleton_key {
+    static const void* id() noexcept {
+        return &detail::registered_singleton<T, Tag>;
+    }
+};
+
+/**
+ * @brief Constructs a set of singletons up front, in dependency order, and
+ * destroys them in reverse.
+ *
+ * @ref singleton constructs its object on first use, so the first request to
+ * use it pays for the construction, and every later call checks a guard
+ * variable. Its objects are destroyed at exit in whatever order the runtime
+ * picks. A registry moves both to points the program chooses:
+ *
+ * 1. At startup, each singleton type is registered with add(), along with
+ *    the singletons its constructor uses.
+ * 2. warm_up() constructs every registered singleton before any traffic
+ *    arrives. A singleton is only constructed after all its dependencies.
+ *    Singletons whose dependencies are all ready are constructed in
+ *    parallel, on up to `max_threads` threads.
+ * 3. get() returns a singleton by loading one global pointer, with no guard
+ *    and no lock.
+ * 4. tear_down(), or the registry's destructor, destroys the singletons in
+ *    the reverse order, so each one is destroyed before its dependencies.
+ *
+ * Each singleton type and tag can be constructed by only one registry at a
+ * time. add() and warm_up() are not thread-safe, and get() must not race
+ * with warm_up() or tear_down().
+ *
+ * Example
+ * -------
+ *
+ *      singleton_registry registry;
+ *      registry.add<config>();
+ *      registry.add<logger>(singleton_key<config>{});
+ *      registry.add<database>(singleton_key<config>{},
+ *                             singleton_key<logger>{});
+ *      registry.warm_up();
+ *
+ *      database& db = singleton_registry::get<database>();
+ */
+class singleton_registry {
+  public:
+    singleton_registry() = default;
+    singleton_registry(const singleton_registry&) = delete;
+    singleton_registry& operator=(const singleton_registry&) = delete;
+
+    /**
+     * @brief Destroys every singleton constructed by this registry.
+     */
+    ~singleton_registry() {
+        tear_down();
+    }
+
+    /**
+     * @brief Registers a singleton type.
+     *
+     * @tparam T The type of singleton object. Must be default-constructable.
+     * @tparam Tag Distinguishes between different singletons of the same
+     * type.
+     * @param dependencies A @ref singleton_key for each singleton that must
+     * be constructed before this one, and destroyed after it.
+     * @throws std::invalid_argument if the singleton is already registered.
+     * @throws std::logic_error if the registry is warmed up.
+     */
+    template <class T, class Tag = default_singleton_tag, class... Keys>
+    void add([[maybe_unused]] Keys... dependencies) {
+        static_assert(std::is_default_constructible_v<T>,
+                      "Singleton type is not default constructable");
+        if (warm_) {
+            throw std::logic_error{"singleton registry is already warm"};
+        }
+        const void* id = singleton_key<T, Tag>::id();
+        for (const entry& e : entries_) {
+            if (e.id == id) {
+                throw std::invalid_argument{"singleton is already registered"};
+            }
+        }
+        entries_.push_back(entry{id, {Keys::id()...}, &construct<T, Tag>,
+                                 &destroy<T, Tag>});
+    }
+
+    /**
+     * @brief Constructs every registered singleton, in dependency order.
+     *
+     * Does nothing if the registry is already warm. If a constructor throws,
+     * the singletons constructed so far are destroyed in reverse order, and
+     * the exception is rethrown.
+     *
+     * @param max_threads Most threads to construct singletons on, including
+     * the calling thread. If a thread cannot be started, the threads already
+     * running do the work instead.
+     * @throws std::invalid_argument if a dependency is not registered.
+     * @throws std::logic_error if the dependencies form a cycle, or if a
+     * singleton is already constructed by another registry.
+     */
+    void warm_up(std::size_t max_threads = std::max(
+                     1u, std::thread::hardware_concurrency())) {
+        if (warm_) {
+            return;
+        }
+        const auto levels = dependency_levels();
+        try {
+            for (const auto& level : levels) {
+                construct_level(level, max_threads);
+            }
+        } catch (...) {
+            tear_down();
+            throw;
+        }
+        warm_ = true;
+    }
+
+    /**
+     * @brief Destroys every singleton constructed by this registry, each one
+     * before its dependencies.
+     *
+     * The singletons stay registered, and warm_up() may construct them again.
+     */
+    void tear_down() noexcept {
+        for (auto it = constructed_.rbegin(); it != constructed_.rend();
+             ++it) {
+            entries_[*it].destroy();
+        }
+        constructed_.clear();
+        warm_ = false;
+    }
+
+    /**
+     * @return true between a successful warm_up() and tear_down().
+     */
+    bool warm() const noexcept {
+        return warm_;
+    }
+
+    /**
+     * @return The singleton object. It must have been constructed by a warm
+     * registry.
+     */
+    template <class T, class Tag = default_singleton_tag>
+    static T& get() noexcept {
+        return *detail::registered_singleton<T, Tag>;
+    }
+
+    /**
+     * @return The singleton object, or nullptr if no registry has constructed
+     * it.
+     */
+    template <class T, class Tag = default_singleton_tag>
+    static T* find() noexcept {
+        return detail::registered_singleton<T, Tag>;
+    }
+
+  private:
+    struct entry {
+        const void* id;
+        std::vector<const void*> dependencies;
+        void (*construct)();
+        void (*destroy)() noexcept;
+    };
+
+    template <class T, class Tag>
+    static void construct() {
+        T*& slot = detail::registered_singleton<T, Tag>;
+        if (slot) {
+            throw std::logic_error{
+                "singleton is already constructed by another registry"};
+        }
+        slot = new T{};
+    }
+
+    template <class T, class Tag>
+    static void destroy() noexcept {
+        delete std::exchange(detail::registered_singleton<T, Tag>, nullptr);
+    }
+
+    // Groups the entries into levels. Every dependency of an entry is in an
+    // earlier level, so each level can be constructed in parallel.
+    std::vector<std::vector<std::size_t>> dependency_levels() const {
+        std::unordered_map<const void*, std::size_t> index;
+        for (std::size_t i = 0; i < entries_.size(); ++i) {
+            index.emplace(entries_[i].id, i);
+        }
+
+        std::vector<std::size_t> waiting_on(entries_.size(), 0);
+        std::vector<std::vector<std::size_t>> dependents(entries_.size());
+        for (std::size_t i = 0; i < entries_.size(); ++i) {
+            for (const void* dependency : entries_[i].dependencies) {
+                auto it = index.find(dependency);
+                if (it == index.end()) {
+                    throw std::invalid_argument{
+                        "singleton dependency is not registered"};
+                }
+                dependents[it->second].push_back(i);
+                ++waiting_on[i];
+            }
+        }
+
+        std::vector<std::vector<std::size_t>> levels;
+        std::vector<std::size_t> ready;
+        for (std::size_t i = 0; i < entries_.size(); ++i) {
+            if (waiting_on[i] == 0) {
+                ready.push_back(i);
+            }
+        }
+        std::size_t placed = 0;
+        while (!ready.empty()) {
+            std::vector<std::size_t> next;
+            for (std::size_t i : ready) {
+                for (std::size_t dependent : dependents[i]) {
+                    if (--waiting_on[dependent] == 0) {
+                        next.push_back(dependent);
+                    }
+                }
+            }
+            placed += ready.size();
+            levels.push_back(std::move(ready));
+            ready = std::move(next);
+        }
+        if (placed != entries_.size()) {
+            throw std::logic_error{"singleton dependencies form a cycle"};
+        }
+        return levels;
+    }
+
+    // Constructs the entries of one level, sharing them out between up to
+    // `max_threads` threads. Entries that were constructed are recorded even
+    // if another one throws.
+    void construct_level(const std::vector<std::size_t>& level,
+                         std::size_t max_threads) {
+        std::vector<char> done(level.size(), 0);
+        std::atomic<std::size_t> next{0};
+        std::mutex error_mtx;
+        std::exception_ptr error;
+        auto work = [&] {
+            for (std::size_t i; (i = next.fetch_add(1)) < level.size();) {
+                try {
+                    entries_[level[i]].construct();
+                    done[i] = 1;
+                } catch (...) {
+                    std::lock_guard<std::mutex> lk{error_mtx};
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> helpers;
+        const std::size_t threads = std::min(max_threads, level.size());
+        helpers.reserve(threads > 0 ? threads - 1 : 0);
+        for (std::size_t t = 1; t < threads; ++t) {
+            try {
+                helpers.emplace_back(work);
+            } catch (...) {
+                // No more threads can be started, whether for lack of system
+                // resources or memory. The calling thread and the helpers
+                // already running share out the rest of the level.
+                break;
+            }
+        }
+        work();
+        for (auto& helper : helpers) {
+            helper.join();
+        }
+
+        for (std::size_t i = 0; i < level.size(); ++i) {
+            if (done[i]) {
+                constructed_.push_back(level[i]);
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::vector<entry> entries_;
+    // Indices into entries_, in the order they were constructed.
+    std::vector<std::size_t> constructed_;
+    bool warm_{false};
+};
+
+} // namespace samwarring
+
+#endif
@@ -0,0 +1,260 @@
+#ifndef INCLUDED_SAMWARRING_SOA_RING_BUFFER_HPP
+#define INCLUDED_SAMWARRING_SOA_RING_BUFFER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace samwarring {
+
+/**
+ * @brief View of one field of a @ref soa_ring_buffer, as a window of its own.
+ *
+ * Like @ref ring_buffer, the items are split into at most two contiguous
+ * spans, given by first_part() and second_part(). Kernels written against
+ * those spans, such as the ones in @ref simd, work on a column unchanged.
+ *
+ * A column is invalidated by any push into its buffer.
+ *
+ * @tparam T Field type, const-qualified for a read-only view.
+ */
+template <class T>
+class soa_column {
+  public:
+    using value_type = std::remove_const_t<T>;
+
+    /**
+     * @brief Contiguous span of a column.
+     */
+    class partition {
+      public:
+        T* begin() const noexcept {
+            return begin_;
+        }
+
+        T* end() const noexcept {
+            return end_;
+        }
+
+        std::size_t size() const noexcept {
+            return static_cast<std::size_t>(end_ - begin_);
+        }
+
+      private:
+        friend class soa_column;
+        partition(T* begin, T* end) noexcept : begin_{begin}, end_{end} {}
+
+        T* begin_;
+        T* end_;
+    };
+
+    soa_column(T* data, std::size_t capacity, std::size_t front,
+               std::size_t size) noexcept
+        : data_{data}, capacity_{capacity}, front_{front}, size_{size} {}
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    /**
+     * @return The field of the item `index` places from the front.
+     */
+    T& operator[](std::size_t index) const noexcept {
+        const std::size_t i = front_ + index;
+        return data_[i >= capacity_ ? i - capacity_ : i];
+    }
+
+    T& front() const noexcept {
+        return (*this)[0];
+    }
+
+    T& back() const noexcept {
+        return (*this)[size_ - 1];
+    }
+
+    /**
+     * @return The oldest items, up to the end of the storage.
+     */
+    partition first_part() const noexcept {
+        const std::size_t end = std::min(front_ + size_, capacity_);
+        return partition{data_ + front_, data_ + end};
+    }
+
+    /**
+     * @return The items that wrapped around to the start of the storage.
+     */
+    partition second_part() const noexcept {
+        const std::size_t end = front_ + size_;
+        return partition{data_,
+                         data_ + (end > capacity_ ? end - capacity_ : 0)};
+    }
+
+  private:
+    T* data_;
+    std::size_t capacity_;
+    std::size_t front_;
+    std::size_t size_;
+};
+
+/**
+ * @brief Ring buffer of records that stores each field in its own contiguous
+ * ring.
+ *
+ * A `ring_buffer<record>` stores whole records side by side, so a scan over
+ * one field also pulls every other field of each record through the cache. A
+ * soa_ring_buffer (structure of arrays) stores field `I` of every record in
+ * array `I` instead. All the arrays share one set of indices, so a record
+ * sits at the same position in each of them.
+ *
+ * column<I>() returns a @ref soa_column view of one field. Its first_part()
+ * and second_part() spans stream only that field's bytes, and the @ref simd
+ * kernels accept it directly.
+ *
+ * Like @ref ring_buffer, each push overwrites the oldest record once the
+ * buffer is full. Unlike it, every slot is default-constructed up front, and
+ * pushes assign the fields into their slots.
+ *
+ * Example
+ * -------
+ *
+ *      soa_ring_buffer<std::int64_t, double, std::uint8_t> window{4096};
+ *      window.push_back(timestamp, value, flags);
+ *
+ *      double total = simd::sum(window.column<1>());
+ *
+ * @tparam Fields Field types. They must be default-constructible and
+ * copy-assignable.
+ */
+template <class... Fields>
+class soa_ring_buffer {
+    static_assert(sizeof...(Fields) > 0, "A record needs at least one field");
+
+  public:
+    /**
+     * @brief Type of field `I`.
+     */
+    template <std::size_t I>
+    using field_type = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    /**
+     * @brief Constructs an empty buffer.
+     *
+     * Every field array is allocated and default-constructed.
+     *
+     * @param capacity Number of records in the buffer.
+     */
+    explicit soa_ring_buffer(std::size_t capacity)
+        : columns_{std::make_unique<Fields[]>(capacity)...},
+          capacity_{capacity} {}
+
+    std::size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    /**
+     * @return Number of records in the buffer, up to capacity().
+     */
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    bool full() const noexcept {
+        return size_ == capacity_;
+    }
+
+    /**
+     * @brief Removes every record. The fields keep their last values until
+     * they are overwritten.
+     */
+    void clear() noexcept {
+        next_ = 0;
+        size_ = 0;
+    }
+
+    /**
+     * @brief Pushes a record, overwriting the oldest one if the buffer is
+     * full.
+     */
+    void push_back(const Fields&... fields) {
+        assign_fields(std::index_sequence_for<Fields...>{}, fields...);
+        next_ = next_ + 1 == capacity_ ? 0 : next_ + 1;
+        if (size_ < capacity_) {
+            ++size_;
+        }
+    }
+
+    /**
+     * @return View of field `I` of every record.
+     */
+    template <std::size_t I>
+    soa_column<field_type<I>> column() noexcept {
+        return {std::get<I>(columns_).get(), capacity_, front_index(), size_};
+    }
+
+    template <std::size_t I>
+    soa_column<const field_type<I>> column() const noexcept {
+        return {std::get<I>(columns_).get(), capacity_, front_index(), size_};
+    }
+
+    /**
+     * @return Field `I` of the record `index` places from the front.
+     */
+    template <std::size_t I>
+    field_type<I>& get(std::size_t index) noexcept {
+        return std::get<I>(columns_)[nth_index(index)];
+    }
+
+    template <std::size_t I>
+    const field_type<I>& get(std::size_t index) const noexcept {
+        return std::get<I>(columns_)[nth_index(index)];
+    }
+
+    /**
+     * @return References to every field of the record `index` places from
+     * the front.
+     */
+    std::tuple<const Fields&...> row(std::size_t index) const noexcept {
+        return row(nth_index(index), std::index_sequence_for<Fields...>{});
+    }
+
+  private:
+    template <std::size_t... I>
+    void assign_fields(std::index_sequence<I...>, const Fields&... fields) {
+        ((std::get<I>(columns_)[next_] = fields), ...);
+    }
+
+    template <std::size_t... I>
+    std::tuple<const Fields&...>
+    row(std::size_t slot, std::index_sequence<I...>) const noexcept {
+        return {std::get<I>(columns_)[slot]...};
+    }
+
+    std::size_t front_index() const noexcept {
+        return next_ >= size_ ? next_ - size_ : next_ + capacity_ - size_;
+    }
+
+    std::size_t nth_index(std::size_t index) const noexcept {
+        const std::size_t i = front_index() + index;
+        return i >= capacity_ ? i - capacity_ : i;
+    }
+
+    std::tuple<std::unique_ptr<Fields[]>...> columns_;
+    std::size_t capacity_;
+    std::size_t next_{0};
+    std::size_t size_{0};
+};
+
+} // namespace samwarring
+
+#endif
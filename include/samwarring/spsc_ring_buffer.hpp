@@ -0,0 +1,411 @@
+#ifndef INCLUDED_SAMWARRING_SPSC_RING_BUFFER_HPP
+#define INCLUDED_SAMWARRING_SPSC_RING_BUFFER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <samwarring/detail/cache_line.hpp>
+#include <samwarring/wait_strategy.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace samwarring {
+
+/**
+ * @brief Lock-free bounded queue for one producer thread and one consumer
+ * thread.
+ *
+ * Unlike @ref ring_buffer, pushing into a full spsc_ring_buffer does not
+ * overwrite the oldest item. Instead, try_push fails and the producer decides
+ * what to do. Items are removed in FIFO order with try_pop.
+ *
+ * The producer owns the tail index and the consumer owns the head index. Each
+ * index lives on its own cache line, next to a private copy of the other
+ * thread's index. Threads only read each other's cache line when their
+ * private copy says the queue looks full (producer) or empty (consumer), so
+ * in steady state the two threads do not false-share.
+ *
+ * Slots are left uninitialized until an item is pushed into them, and items
+ * are destroyed as they are popped. The element type does not need to be
+ * default-constructable.
+ *
+ * The blocking functions (push, emplace, pop and the timed try_*_until
+ * forms) wait for room or for an item with `WaitStrategy`, which is chosen at
+ * compile time from those in wait_strategy.hpp. The default, @ref busy_spin,
+ * never sleeps, so it adds nothing to the non-blocking functions. With
+ * @ref spin_futex, a consumer with nothing to do sleeps in the kernel, and
+ * the producer wakes it when the next item arrives.
+ *
+ * At most one thread may call the producer functions (try_push, try_emplace,
+ * push, emplace and try_push_until), and at most one thread may call the
+ * consumer functions (try_pop, pop and try_pop_until). Other functions may be
+ * called from either thread.
+ *
+ * Example
+ * -------
+ *
+ *      spsc_ring_buffer<int> queue{1024};
+ *
+ *      // Producer thread
+ *      while (!queue.try_push(sample)) {
+ *          // full; back off
+ *      }
+ *
+ *      // Consumer thread
+ *      int sample;
+ *      if (queue.try_pop(sample)) {
+ *          process(sample);
+ *      }
+ *
+ *      // Consumer thread that sleeps while the queue is empty
+ *      spsc_ring_buffer<int, spin_futex<>> queue{1024};
+ *      queue.pop(sample);
+ *
+ * @tparam T Element type. Must be move-constructable.
+ * @tparam WaitStrategy How the blocking functions wait.
+ */
+template <class T, class WaitStrategy = busy_spin>
+class alignas(detail::cache_line_size) spsc_ring_buffer {
+    static_assert(std::is_move_constructible_v<T>,
+                  "Item type is not move-constructable");
+
+  public:
+    /**
+     * @brief Constructs an empty queue that can hold `capacity` items.
+     *
+     * @param capacity Maximum number of items in the queue. Must be non-zero.
+     */
+    explicit spsc_ring_buffer(std::size_t capacity)
+        : data_{std::allocator<T>{}.allocate(capacity + 1)},
+          slots_{capacity + 1} {}
+
+    spsc_ring_buffer(const spsc_ring_buffer&) = delete;
+    spsc_ring_buffer(spsc_ring_buffer&&) = delete;
+    spsc_ring_buffer& operator=(const spsc_ring_buffer&) = delete;
+    spsc_ring_buffer& operator=(spsc_ring_buffer&&) = delete;
+
+    /**
+     * @brief Destroys all items remaining in the queue, and releases memory.
+     *
+     * Neither the producer nor the consumer may be using the queue.
+     */
+    ~spsc_ring_buffer() {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        while (head != tail) {
+            data_[head].~T();
+            head = next_index(head);
+        }
+        std::allocator<T>{}.deallocate(data_, slots_);
+    }
+
+    /**
+     * @return Maximum number of items the queue can hold.
+     */
+    std::size_t capacity() const noexcept {
+        return slots_ - 1;
+    }
+
+    /**
+     * @brief Returns the number of items in the queue.
+     *
+     * When called while the other thread is active, the result is only a
+     * snapshot and may be stale by the time it is returned.
+     */
+    std::size_t size() const noexcept {
+        std::size_t head = head_.load(std::memory_order_acquire);
+        std::size_t tail = tail_.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : tail + slots_ - head;
+    }
+
+    /**
+     * @return true if the queue holds no items. Same caveats as size().
+     */
+    bool empty() const noexcept {
+        return head_.load(std::memory_order_acquire) ==
+               tail_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Constructs an item in place at the back of the queue.
+     *
+     * Producer only.
+     *
+     * @return true if the item was pushed, or false if the queue was full. If
+     * the queue was full, the arguments are not used.
+     */
+    template <class... Args>
+    bool try_emplace(Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<T, Args&&...>) {
+        T* slot = back_slot();
+        if (!slot) {
+            return false;
+        }
+        ::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+        push_back();
+        return true;
+    }
+
+    /**
+     * @brief Copies an item to the back of the queue. Producer only.
+     *
+     * @return true if the item was pushed, or false if the queue was full.
+     */
+    bool try_push(const T& item) noexcept(
+        std::is_nothrow_copy_constructible_v<T>) {
+        return try_emplace(item);
+    }
+
+    /**
+     * @brief Moves an item to the back of the queue. Producer only.
+     *
+     * @return true if the item was pushed, or false if the queue was full. If
+     * the queue was full, `item` is not moved-from.
+     */
+    bool try_push(T&& item) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        return try_emplace(std::move(item));
+    }
+
+    /**
+     * @brief Moves the item at the front of the queue into `item`.
+     *
+     * Consumer only.
+     *
+     * @param item Receives the oldest item by move-assignment.
+     * @return true if an item was popped, or false if the queue was empty.
+     */
+    bool try_pop(T& item) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        T* slot = front_slot();
+        if (!slot) {
+            return false;
+        }
+        item = std::move(*slot);
+        pop_front();
+        return true;
+    }
+
+    /**
+     * @brief Constructs an item in place at the back of the queue, waiting
+     * while the queue is full.
+     *
+     * Producer only.
+     */
+    template <class... Args>
+    void emplace(Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<T, Args&&...>) {
+        T* slot;
+        not_full_.wait([&] { return (slot = back_slot()) != nullptr; });
+        ::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+        push_back();
+    }
+
+    /**
+     * @brief Copies an item to the back of the queue, waiting while the queue
+     * is full. Producer only.
+     */
+    void push(const T& item) noexcept(std::is_nothrow_copy_constructible_v<T>) {
+        emplace(item);
+    }
+
+    /**
+     * @brief Moves an item to the back of the queue, waiting while the queue
+     * is full. Producer only.
+     */
+    void push(T&& item) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        emplace(std::move(item));
+    }
+
+    /**
+     * @brief Copies an item to the back of the queue, waiting until
+     * `deadline` while the queue is full. Producer only.
+     *
+     * @return true if the item was pushed, or false if the queue was still
+     * full at the deadline.
+     */
+    template <class Clock, class Duration>
+    bool try_push_until(
+        const T& item,
+        const std::chrono::time_point<Clock, Duration>& deadline) {
+        if (!not_full_.wait_until([&] { return back_slot() != nullptr; },
+                                  deadline)) {
+            return false;
+        }
+        return try_emplace(item);
+    }
+
+    /**
+     * @brief Moves an item to the back of the queue, waiting until `deadline`
+     * while the queue is full. Producer only.
+     *
+     * @return true if the item was pushed, or false if the queue was still
+     * full at the deadline. In that case, `item` is not moved-from.
+     */
+    template <class Clock, class Duration>
+    bool try_push_until(
+        T&& item, const std::chrono::time_point<Clock, Duration>& deadline) {
+        if (!not_full_.wait_until([&] { return back_slot() != nullptr; },
+                                  deadline)) {
+            return false;
+        }
+        return try_emplace(std::move(item));
+    }
+
+    /**
+     * @brief Moves the item at the front of the queue into `item`, waiting
+     * while the queue is empty. Consumer only.
+     */
+    void pop(T& item) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        T* slot;
+        not_empty_.wait([&] { return (slot = front_slot()) != nullptr; });
+        item = std::move(*slot);
+        pop_front();
+    }
+
+    /**
+     * @brief Moves the item at the front of the queue into `item`, waiting
+     * until `deadline` while the queue is empty. Consumer only.
+     *
+     * @return true if an item was popped, or false if the queue was still
+     * empty at the deadline.
+     */
+    template <class Clock, class Duration>
+    bool
+    try_pop_until(T& item,
+                  const std::chrono::time_point<Clock, Duration>& deadline) {
+        if (!not_empty_.wait_until([&] { return front_slot() != nullptr; },
+                                   deadline)) {
+            return false;
+        }
+        return try_pop(item);
+    }
+
+    /**
+     * @brief Hands up to `max` items at the front of the queue to `fn` in
+     * place, then removes them all at once.
+     *
+     * The ready items occupy at most two contiguous spans of the storage, as
+     * with @ref ring_buffer::first_part and @ref ring_buffer::second_part.
+     * `fn(begin, end)` is called once per non-empty span, oldest first. It may
+     * read the items or move from them. Afterwards, the items are destroyed
+     * and the head index is published once for the whole batch. Index
+     * arithmetic and cache-line traffic with the producer are paid once per
+     * batch rather than once per item.
+     *
+     * If `fn` throws, the spans it already returned from are consumed, and
+     * the span it threw from is left in the queue.
+     *
+     * Consumer only.
+     *
+     * @param max Maximum number of items to consume.
+     * @param fn Callable as `fn(T* begin, T* end)`.
+     * @return Number of items consumed. Zero if the queue was empty.
+     */
+    template <class Fn>
+    std::size_t consume_batch(std::size_t max, Fn&& fn) {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        tail_cache_ = tail_.load(std::memory_order_acquire);
+        const std::size_t ready = tail_cache_ >= head
+                                      ? tail_cache_ - head
+                                      : tail_cache_ + slots_ - head;
+        const std::size_t count = std::min(ready, max);
+        if (count == 0) {
+            return 0;
+        }
+        const std::size_t first = std::min(count, slots_ - head);
+        fn(data_ + head, data_ + head + first);
+        if (first < count) {
+            try {
+                fn(data_, data_ + (count - first));
+            } catch (...) {
+                pop_front(first);
+                throw;
+            }
+        }
+        pop_front(count);
+        return count;
+    }
+
+  private:
+    // Returns the slot for the next item, or nullptr if the queue is full.
+    T* back_slot() noexcept {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        const std::size_t next = next_index(tail);
+        if (next == head_cache_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (next == head_cache_) {
+                return nullptr;
+            }
+        }
+        return data_ + tail;
+    }
+
+    // Publishes the item constructed in back_slot().
+    void push_back() noexcept {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        tail_.store(next_index(tail), std::memory_order_release);
+        not_empty_.notify();
+    }
+
+    // Returns the oldest item, or nullptr if the queue is empty.
+    T* front_slot() noexcept {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return nullptr;
+            }
+        }
+        return data_ + head;
+    }
+
+    void pop_front() noexcept {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        data_[head].~T();
+        head_.store(next_index(head), std::memory_order_release);
+        not_full_.notify();
+    }
+
+    // Destroys the `count` oldest items and publishes the new head once.
+    void pop_front(std::size_t count) noexcept {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if constexpr (std::is_trivially_destructible_v<T>) {
+            head += count;
+            head = head >= slots_ ? head - slots_ : head;
+        } else {
+            for (; count; --count) {
+                data_[head].~T();
+                head = next_index(head);
+            }
+        }
+        head_.store(head, std::memory_order_release);
+        not_full_.notify();
+    }
+
+    std::size_t next_index(std::size_t index) const noexcept {
+        return ++index == slots_ ? 0 : index;
+    }
+
+    // Read-only after construction. One slot is always left empty so that
+    // head == tail unambiguously means "empty".
+    T* const data_;
+    const std::size_t slots_;
+
+    // Written by the producer. The consumer only writes to not_empty_ when
+    // it is about to sleep.
+    alignas(detail::cache_line_size) std::atomic<std::size_t> tail_{0};
+    std::size_t head_cache_{0};
+    WaitStrategy not_empty_;
+
+    // Written by the consumer. The producer only writes to not_full_ when it
+    // is about to sleep.
+    alignas(detail::cache_line_size) std::atomic<std::size_t> head_{0};
+    std::size_t tail_cache_{0};
+    WaitStrategy not_full_;
+};
+
+} // namespace samwarring
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef INCLUDED_SAMWARRING_STATIC_RING_BUFFER_HPP
+#define INCLUDED_SAMWARRING_STATIC_RING_BUFFER_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace samwarring {
+
+/**
+ * Fixed-size buffer with a compile-time capacity, where each insertion
+ * overwrites the oldest element.
+ *
+ * static_ring_buffer behaves like @ref ring_buffer, except that its capacity
+ * N is a template parameter and its elements are stored inline in the object
+ * instead of on the heap. Because N is a constant, wrapping an index around
+ * the end of the buffer never needs a division: when N is a power of two it is
+ * a bit mask, and otherwise it is a single compare-and-subtract. All
+ * operations are constexpr, so a static_ring_buffer can be filled and read
+ * during constant evaluation.
+ *
+ * All N items are default-constructed (value-initialized) when the buffer is
+ * constructed, and push_back move-assigns into an existing element.
+ *
+ * Example
+ * -------
+ *
+ *      static_ring_buffer<int, 3> buf;  // [0, 0, 0]
+ *      buf.push_back(7);                // [0, 0, 7]
+ *      buf.push_back(3);                // [0, 7, 3]
+ *      buf.push_back(9);                // [7, 3, 9]
+ *      buf.push_back(2);                // [3, 9, 2]
+ *
+ * @tparam T Element type. Must be default-constructable and move-assignable.
+ * @tparam N Number of elements. Must be non-zero.
+ */
+template <class T, std::size_t N>
+class static_ring_buffer {
+    static_assert(N > 0, "Capacity must be non-zero");
+    static_assert(std::is_default_constructible_v<T>,
+                  "Item type is not default-constructable");
+    static_assert(std::is_move_assignable_v<T>,
+                  "Item type is not move-assignable");
+
+  public:
+    /**
+     * Constructs a new ring buffer. All items are value-initialized.
+     */
+    constexpr static_ring_buffer() noexcept(
+        std::is_nothrow_default_constructible_v<T>)
+        : data_{}, next_{0} {}
+
+    static constexpr std::size_t capacity() noexcept {
+        return N;
+    }
+
+    constexpr void
+    push_back(T item) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        data_[next_] = std::move(item);
+        next_ = wrap(next_ + 1);
+    }
+
+    constexpr T& operator[](std::size_t index) noexcept {
+        return data_[wrap(next_ + index)];
+    }
+
+    constexpr const T& operator[](std::size_t index) const noexcept {
+        return data_[wrap(next_ + index)];
+    }
+
+    constexpr T& front() noexcept {
+        return data_[next_];
+    }
+
+    constexpr const T& front() const noexcept {
+        return data_[next_];
+    }
+
+    constexpr T& back() noexcept {
+        return data_[wrap(next_ + N - 1)];
+    }
+
+    constexpr const T& back() const noexcept {
+        return data_[wrap(next_ + N - 1)];
+    }
+
+  public:
+    template <class U>
+    class iterator_base {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = std::remove_const_t<U>;
+        using pointer = U*;
+        using reference = U&;
+
+        constexpr U& operator*() const noexcept {
+            return data_[wrap(front_ + offset_)];
+        }
+
+        constexpr U* operator->() const noexcept {
+            return &**this;
+        }
+
+        constexpr bool operator==(const iterator_base& other) const noexcept {
+            return offset_ == other.offset_;
+        }
+
+        constexpr bool operator!=(const iterator_base& other) const noexcept {
+            return offset_ != other.offset_;
+        }
+
+        constexpr iterator_base& operator++() noexcept {
+            ++offset_;
+            return *this;
+        }
+
+        constexpr iterator_base operator++(int) noexcept {
+            auto tmp = *this;
+            ++offset_;
+            return tmp;
+        }
+
+      private:
+        friend class static_ring_buffer;
+
+        constexpr iterator_base(U* data, std::size_t front,
+                                std::size_t offset) noexcept
+            : data_{data}, front_{front}, offset_{offset} {}
+
+        U* data_;
+        std::size_t front_;
+        std::size_t offset_;
+    };
+
+    using iterator = iterator_base<T>;
+    using const_iterator = iterator_base<const T>;
+
+    template <class U>
+    class partition_base {
+      public:
+        constexpr U* begin() const noexcept {
+            return begin_;
+        }
+
+        constexpr U* end() const noexcept {
+            return end_;
+        }
+
+      private:
+        friend class static_ring_buffer;
+        constexpr partition_base(U* begin, U* end) noexcept
+            : begin_{begin}, end_{end} {}
+
+        U* begin_;
+        U* end_;
+    };
+
+    using partition = partition_base<T>;
+    using const_partition = partition_base<const T>;
+
+    constexpr iterator begin() noexcept {
+        return iterator{data_, next_, 0};
+    }
+
+    constexpr const_iterator begin() const noexcept {
+        return const_iterator{data_, next_, 0};
+    }
+
+    constexpr iterator end() noexcept {
+        return iterator{data_, next_, N};
+    }
+
+    constexpr const_iterator end() const noexcept {
+        return const_iterator{data_, next_, N};
+    }
+
+    constexpr partition first_part() noexcept {
+        return partition{data_ + next_, data_ + N};
+    }
+
+    constexpr const_partition first_part() const noexcept {
+        return const_partition{data_ + next_, data_ + N};
+    }
+
+    constexpr partition second_part() noexcept {
+        return partition{data_, data_ + next_};
+    }
+
+    constexpr const_partition second_part() const noexcept {
+        return const_partition{data_, data_ + next_};
+    }
+
+  private:
+    // Maps a position in [0, 2 * N) back into [0, N).
+    static constexpr std::size_t wrap(std::size_t index) noexcept {
+        if constexpr ((N & (N - 1)) == 0) {
+            return index & (N - 1);
+        } else {
+            return index >= N ? index - N : index;
+        }
+    }
+
+    T data_[N];
+    std::size_t next_;
+};
+
+} // namespace samwarring
+
+#endif
@@ -0,0 +1,455 @@
+#ifndef INCLUDED_SAMWARRING_TIME_WINDOW_RING_HPP
+#define INCLUDED_SAMWARRING_TIME_WINDOW_RING_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <samwarring/ring_buffer.hpp>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace samwarring {
+
+namespace detail {
+
+/**
+ * @brief Sorted multiset of values with lookup by rank.
+ *
+ * The values are kept in order in a list of chunks, each a sorted vector of
+ * at most `max_chunk` values. A value is inserted or erased by binary search
+ * for its chunk, and then for its place in the chunk, so only that chunk's
+ * values are shifted. A Fenwick tree over the chunk sizes gives the number of
+ * values before any chunk, so nth() finds its chunk in O(log n) as well.
+ *
+ * A chunk that grows past `max_chunk` is split in two, and one that drops
+ * below a quarter of it is merged into a neighbour. Splits and merges shift
+ * the list of chunks and rebuild the tree, in O(n / max_chunk). They are rare
+ * next to ordinary updates: a split leaves two half-full chunks, each of
+ * which takes another `max_chunk / 4` erases before it can be merged.
+ */
+template <class T>
+class order_statistic_multiset {
+  public:
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    void insert(const T& value) {
+        if (chunks_.empty()) {
+            chunks_.push_back(std::vector<T>{value});
+            ++size_;
+            rebuild_counts();
+            return;
+        }
+        // The first chunk whose largest value is greater, or the last chunk.
+        auto chunk = std::partition_point(
+            chunks_.begin(), chunks_.end() - 1,
+            [&](const std::vector<T>& c) { return !(value < c.back()); });
+        chunk->insert(std::upper_bound(chunk->begin(), chunk->end(), value),
+                      value);
+        ++size_;
+        if (chunk->size() > max_chunk) {
+            const auto middle = chunk->begin() + chunk->size() / 2;
+            std::vector<T> upper(std::make_move_iterator(middle),
+                                 std::make_move_iterator(chunk->end()));
+            chunk->erase(middle, chunk->end());
+            chunks_.insert(chunk + 1, std::move(upper));
+            rebuild_counts();
+        } else {
+            add_count(chunk - chunks_.begin(), 1);
+        }
+    }
+
+    // Erases one value equal to `value`, which must be in the set.
+    void erase_one(const T& value) {
+        // The first value not less than `value` is in the first chunk whose
+        // largest value is not less than it.
+        auto chunk = std::partition_point(
+            chunks_.begin(), chunks_.end(),
+            [&](const std::vector<T>& c) { return c.back() < value; });
+        chunk->erase(std::lower_bound(chunk->begin(), chunk->end(), value));
+        --size_;
+        if (chunk->empty()) {
+            chunks_.erase(chunk);
+            rebuild_counts();
+        } else if (chunk->size() < max_chunk / 4 && chunks_.size() > 1) {
+            // Merges the chunk into its smaller neighbour, if that fits.
+            auto first = chunk;
+            if (chunk + 1 == chunks_.end() ||
+                (chunk != chunks_.begin() &&
+                 (chunk - 1)->size() < (chunk + 1)->size())) {
+                --first;
+            }
+            auto second = first + 1;
+            if (first->size() + second->size() <= max_chunk) {
+                first->insert(first->end(),
+                              std::make_move_iterator(second->begin()),
+                              std::make_move_iterator(second->end()));
+                chunks_.erase(second);
+                rebuild_counts();
+            } else {
+                add_count(chunk - chunks_.begin(), -1);
+            }
+        } else {
+            add_count(chunk - chunks_.begin(), -1);
+        }
+    }
+
+    // Returns the value with `index` smaller or equal values before it.
+    const T& nth(std::size_t index) const noexcept {
+        // Descends the tree for the last chunk with at most `index` values
+        // before it.
+        std::size_t chunk = 0;
+        for (std::size_t step = top_step_; step; step >>= 1) {
+            if (chunk + step < counts_.size() &&
+                counts_[chunk + step] <= index) {
+                chunk += step;
+                index -= counts_[chunk];
+            }
+        }
+        return chunks_[chunk][index];
+    }
+
+    void clear() noexcept {
+        chunks_.clear();
+        counts_.clear();
+        top_step_ = 0;
+        size_ = 0;
+    }
+
+  private:
+    static constexpr std::size_t max_chunk = 512;
+
+    // Adds `delta` to the size of chunk `chunk` in the Fenwick tree.
+    void add_count(std::ptrdiff_t chunk, std::ptrdiff_t delta) noexcept {
+        for (auto i = static_cast<std::size_t>(chunk) + 1; i < counts_.size();
+             i += i & (~i + 1)) {
+            counts_[i] += static_cast<std::size_t>(delta);
+        }
+    }
+
+    // Rebuilds the Fenwick tree from the chunk sizes, in O(chunks).
+    void rebuild_counts() {
+        counts_.assign(chunks_.size() + 1, 0);
+        for (std::size_t i = 1; i < counts_.size(); ++i) {
+            counts_[i] += chunks_[i - 1].size();
+            const std::size_t parent = i + (i & (~i + 1));
+            if (parent < counts_.size()) {
+                counts_[parent] += counts_[i];
+            }
+        }
+        top_step_ = 1;
+        while (top_step_ * 2 < counts_.size()) {
+            top_step_ *= 2;
+        }
+    }
+
+    // Non-empty chunks, in order.
+    std::vector<std::vector<T>> chunks_;
+    // 1-based Fenwick tree, where counts_[i] is the number of values in the
+    // chunks (i - (i & -i), i].
+    std::vector<std::size_t> counts_;
+    // Largest power of two below counts_.size(), or 0 when there are none.
+    std::size_t top_step_{0};
+    std::size_t size_{0};
+};
+
+} // namespace detail
+
+/**
+ * @brief Sliding window of timestamped values that evicts by age instead of
+ * by count.
+ *
+ * time_window_ring keeps every value pushed within the last `window` of time,
+ * such as "every request in the last 10 seconds". Entries are stored in
+ * arrival order in a @ref ring_buffer, so the oldest entry is always at the
+ * front. Expired entries are evicted from the front whenever a value is pushed
+ * or the window is queried, which costs amortized O(1) per entry.
+ *
+ * The storage grows and shrinks with the traffic, between a minimum and a
+ * maximum number of entries:
+ *
+ * - When the ring is full of unexpired entries, its capacity doubles, up to
+ *   `max_capacity`.
+ * - At `max_capacity`, a push evicts the oldest entry before it expires, and
+ *   dropped() counts it. Memory is therefore bounded even under a burst.
+ * - When eviction leaves the ring at most a quarter full, its capacity
+ *   halves until it is more than a quarter full, down to `min_capacity`.
+ *
+ * Timestamps must not decrease from one push to the next. Every function that
+ * evicts takes the current time as an optional argument, which defaults to
+ * `Clock::now()`. Passing it explicitly saves reading the clock twice, and
+ * makes the window deterministic in tests.
+ *
+ * With `TrackPercentiles`, the window also keeps its values sorted, in chunks
+ * of at most 512. Each push and eviction updates one chunk, so it costs
+ * O(log n) to find it plus at most 512 values shifted, rather than the whole
+ * window. percentile() finds the chunk holding a rank from a tree of running
+ * chunk sizes, in O(log n).
+ *
+ * Example
+ * -------
+ *
+ *      time_window_ring<double, std::chrono::steady_clock, true> latencies{
+ *          std::chrono::seconds{10}, 1 << 16};
+ *      latencies.push_back(sample);
+ *      if (latencies.percentile(0.99) > slo) {
+ *          alert();
+ *      }
+ *
+ * @tparam T Value type. With `TrackPercentiles`, it must be less-than
+ * comparable and copyable.
+ * @tparam Clock Clock providing the timestamps.
+ * @tparam TrackPercentiles Whether to keep the sorted copy for percentile().
+ */
+template <class T, class Clock = std::chrono::steady_clock,
+          bool TrackPercentiles = false>
+class time_window_ring {
+  public:
+    using value_type = T;
+    using clock = Clock;
+    using duration = typename Clock::duration;
+    using time_point = typename Clock::time_point;
+
+    /**
+     * @brief A value and the time it was pushed.
+     */
+    struct entry {
+        time_point time;
+        T value;
+    };
+
+    using const_iterator = typename ring_buffer<entry>::const_iterator;
+
+    /**
+     * @brief Constructs an empty window.
+     *
+     * @param window Age at which entries are evicted. Must be positive.
+     * @param max_capacity Most entries held at once. Must be non-zero.
+     * @param min_capacity Fewest entries the storage shrinks to. It is
+     * clamped to `max_capacity`.
+     * @throws std::invalid_argument if `window` or `max_capacity` is zero.
+     */
+    time_window_ring(duration window, std::size_t max_capacity,
+                     std::size_t min_capacity = 16)
+        : window_{check_window(window)},
+          max_capacity_{check_max_capacity(max_capacity)},
+          min_capacity_{std::max<std::size_t>(
+              1, std::min(min_capacity, max_capacity))},
+          entries_{min_capacity_} {}
+
+    duration window() const noexcept {
+        return window_;
+    }
+
+    /**
+     * @return Number of entries the storage currently has room for.
+     */
+    std::size_t capacity() const noexcept {
+        return entries_.capacity();
+    }
+
+    std::size_t min_capacity() const noexcept {
+        return min_capacity_;
+    }
+
+    std::size_t max_capacity() const noexcept {
+        return max_capacity_;
+    }
+
+    /**
+     * @return Number of entries as of the last push or query. Some of them
+     * may have expired since. Use count() for an up-to-date number.
+     */
+    std::size_t size() const noexcept {
+        return entries_.size();
+    }
+
+    bool empty() const noexcept {
+        return entries_.empty();
+    }
+
+    /**
+     * @return Number of entries evicted before they expired, because the
+     * window was already at max_capacity().
+     */
+    std::uint64_t dropped() const noexcept {
+        return dropped_;
+    }
+
+    /**
+     * @brief Evicts expired entries, then pushes a value stamped with `now`.
+     */
+    void push_back(const T& value, time_point now = Clock::now()) {
+        emplace_back(now, value);
+    }
+
+    void push_back(T&& value, time_point now = Clock::now()) {
+        emplace_back(now, std::move(value));
+    }
+
+    /**
+     * @brief Evicts expired entries, then constructs a value in place stamped
+     * with `now`.
+     *
+     * @return Reference to the new value.
+     */
+    template <class... Args>
+    T& emplace_back(time_point now, Args&&... args) {
+        evict_expired(now);
+        if (entries_.full()) {
+            if (entries_.capacity() < max_capacity_) {
+                entries_.resize(
+                    std::min(entries_.capacity() * 2, max_capacity_));
+            } else {
+                pop_front();
+                ++dropped_;
+            }
+        }
+        entry item{now, T(std::forward<Args>(args)...)};
+        if constexpr (TrackPercentiles) {
+            // The sorted copy is updated first, and the entry is copied
+            // rather than moved if moving may throw, so that the value is
+            // still there to take back out if the push fails.
+            sorted_.insert(item.value);
+            try {
+                return entries_.emplace_back(std::move_if_noexcept(item))
+                    .value;
+            } catch (...) {
+                sorted_.erase_one(item.value);
+                throw;
+            }
+        } else {
+            return entries_.emplace_back(std::move(item)).value;
+        }
+    }
+
+    /**
+     * @brief Evicts every entry that is at least window() old at `now`, and
+     * shrinks the storage if it is mostly empty.
+     */
+    void evict_expired(time_point now = Clock::now()) {
+        const time_point cutoff = now - window_;
+        while (!entries_.empty() && entries_.front().time <= cutoff) {
+            pop_front();
+        }
+        std::size_t capacity = entries_.capacity();
+        while (capacity > min_capacity_ && entries_.size() <= capacity / 4) {
+            capacity = std::max(capacity / 2, min_capacity_);
+        }
+        entries_.resize(capacity);
+    }
+
+    /**
+     * @return Number of entries younger than window() at `now`.
+     */
+    std::size_t count(time_point now = Clock::now()) {
+        evict_expired(now);
+        return entries_.size();
+    }
+
+    /**
+     * @return Entries per second over the window, at `now`.
+     */
+    double rate(time_point now = Clock::now()) {
+        using seconds = std::chrono::duration<double>;
+        return static_cast<double>(count(now)) /
+               std::chrono::duration_cast<seconds>(window_).count();
+    }
+
+    /**
+     * @brief Returns a percentile of the values younger than window() at
+     * `now`, by the nearest-rank method.
+     *
+     * Only available with `TrackPercentiles`.
+     *
+     * @param p Fraction between 0 and 1. For example, 0.99 selects the 99th
+     * percentile. 0 selects the smallest value, and 1 the largest.
+     * @return The smallest value that is at least as large as a fraction `p`
+     * of the values. The window must not be empty at `now`.
+     */
+    const T& percentile(double p, time_point now = Clock::now()) {
+        static_assert(TrackPercentiles,
+                      "percentile() requires TrackPercentiles");
+        evict_expired(now);
+        const double rank = std::ceil(p * static_cast<double>(sorted_.size()));
+        const std::size_t index =
+            rank < 1 ? 0 : static_cast<std::size_t>(rank) - 1;
+        return sorted_.nth(std::min(index, sorted_.size() - 1));
+    }
+
+    /**
+     * @brief Removes every entry. The capacity shrinks to min_capacity().
+     */
+    void clear() {
+        entries_.clear();
+        entries_.resize(min_capacity_);
+        if constexpr (TrackPercentiles) {
+            sorted_.clear();
+        }
+    }
+
+    /**
+     * @return The oldest entry as of the last push or query. The window must
+     * not be empty.
+     */
+    const entry& front() const noexcept {
+        return entries_.front();
+    }
+
+    /**
+     * @return The newest entry. The window must not be empty.
+     */
+    const entry& back() const noexcept {
+        return entries_.back();
+    }
+
+    /**
+     * @return Iterator to the oldest entry as of the last push or query.
+     */
+    const_iterator begin() const noexcept {
+        return entries_.begin();
+    }
+
+    const_iterator end() const noexcept {
+        return entries_.end();
+    }
+
+  private:
+    static duration check_window(duration window) {
+        if (window <= duration::zero()) {
+            throw std::invalid_argument{"window must be positive"};
+        }
+        return window;
+    }
+
+    static std::size_t check_max_capacity(std::size_t max_capacity) {
+        if (max_capacity == 0) {
+            throw std::invalid_argument{"max_capacity must be non-zero"};
+        }
+        return max_capacity;
+    }
+
+    void pop_front() {
+        if constexpr (TrackPercentiles) {
+            // Any equal value will do, since they are indistinguishable.
+            sorted_.erase_one(entries_.front().value);
+        }
+        entries_.pop_front();
+    }
+
+    const duration window_;
+    const std::size_t max_capacity_;
+    const std::size_t min_capacity_;
+    ring_buffer<entry> entries_;
+    detail::order_statistic_multiset<T> sorted_;
+    std::uint64_t dropped_{0};
+};
+
+} // namespace samwarring
+
+#endif
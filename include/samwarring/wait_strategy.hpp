@@ -0,0 +1,286 @@
+#ifndef INCLUDED_SAMWARRING_WAIT_STRATEGY_HPP
+#define INCLUDED_SAMWARRING_WAIT_STRATEGY_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <thread>
+
+#if defined(__linux__)
+#include <samwarring/detail/futex.hpp>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+/**
+ * @file
+ *
+ * Wait strategies decide how a thread waits for a concurrent queue to become
+ * non-empty (or non-full). They trade CPU time for wakeup latency:
+ *
+ * | Strategy      | Waiting thread                 | Wakeup latency      |
+ * |---------------|--------------------------------|---------------------|
+ * | busy_spin     | Spins on one core              | Lowest              |
+ * | spin_yield    | Spins, then yields its core    | Low, but scheduler- |
+ * |               |                                | dependent           |
+ * | spin_futex    | Spins, then sleeps in the      | A few microseconds  |
+ * |               | kernel until notified          | once asleep         |
+ * | timed_wait    | Spins, then sleeps for a fixed | Up to the period    |
+ * |               | period between checks          |                     |
+ *
+ * Every strategy has the same interface:
+ *
+ * - `wait(pred)` returns once `pred()` is true.
+ * - `wait_until(pred, deadline)` also returns at `deadline`, and returns the
+ *   final value of `pred()`.
+ * - `notify()` is called by the other side after every change that may make
+ *   `pred()` true. It is free for the strategies that never sleep without a
+ *   timeout.
+ *
+ * A queue holds one strategy object per condition, as a template parameter,
+ * so the choice costs nothing at run time. See @ref spsc_ring_buffer and
+ * @ref mpmc_ring_buffer.
+ */
+
+namespace samwarring {
+
+namespace detail {
+
+/**
+ * @brief Tells the CPU that the thread is spinning, which saves power and
+ * frees resources for a sibling hyper-thread.
+ */
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Spins up to `spins` times waiting for `pred`. Returns the final value of
+// `pred()`.
+template <class Pred>
+bool spin_for(Pred& pred, std::size_t spins) {
+    for (std::size_t i = 0; i < spins; ++i) {
+        if (pred()) {
+            return true;
+        }
+        cpu_relax();
+    }
+    return pred();
+}
+
+} // namespace detail
+
+/**
+ * @brief Spins on the condition without ever giving up the core.
+ */
+class busy_spin {
+  public:
+    template <class Pred>
+    void wait(Pred pred) {
+        while (!pred()) {
+            detail::cpu_relax();
+        }
+    }
+
+    template <class Pred, class Clock, class Duration>
+    bool wait_until(Pred pred,
+                    const std::chrono::time_point<Clock, Duration>& deadline) {
+        // Reading the clock costs more than a spin, so it is read once per
+        // batch of spins.
+        while (!detail::spin_for(pred, 64)) {
+            if (Clock::now() >= deadline) {
+                return pred();
+            }
+        }
+        return true;
+    }
+
+    void notify() noexcept {}
+};
+
+/**
+ * @brief Spins on the condition for a while, then yields the core between
+ * checks.
+ *
+ * @tparam Spins Number of spins before the first yield.
+ */
+template <std::size_t Spins = 256>
+class spin_yield {
+  public:
+    template <class Pred>
+    void wait(Pred pred) {
+        if (detail::spin_for(pred, Spins)) {
+            return;
+        }
+        while (!pred()) {
+            std::this_thread::yield();
+        }
+    }
+
+    template <class Pred, class Clock, class Duration>
+    bool wait_until(Pred pred,
+                    const std::chrono::time_point<Clock, Duration>& deadline) {
+        if (detail::spin_for(pred, Spins)) {
+            return true;
+        }
+        while (!pred()) {
+            if (Clock::now() >= deadline) {
+                return pred();
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    void notify() noexcept {}
+};
+
+#if defined(__linux__)
+
+/**
+ * @brief Spins on the condition for a while, then sleeps on a futex until
+ * notified.
+ *
+ * The strategy owns a 32-bit epoch that notify() bumps before waking
+ * sleepers, and a flag that a waiter raises before its final check of the
+ * condition. notify() only makes a system call when the flag is raised, and
+ * lowers it when it does, so a burst of notifications while a waiter is
+ * being scheduled costs one system call. Otherwise, notify() is a fence and a
+ * load.
+ *
+ * Every sleeper is woken at once, so the strategy also works for several
+ * waiting threads, as in @ref mpmc_ring_buffer.
+ *
+ * This strategy is only available on Linux.
+ *
+ * @tparam Spins Number of spins before sleeping.
+ */
+template <std::size_t Spins = 256>
+class spin_futex {
+  public:
+    template <class Pred>
+    void wait(Pred pred) {
+        if (detail::spin_for(pred, Spins)) {
+            return;
+        }
+        while (!sleep_unless(pred, nullptr)) {
+        }
+    }
+
+    template <class Pred, class Clock, class Duration>
+    bool wait_until(Pred pred,
+                    const std::chrono::time_point<Clock, Duration>& deadline) {
+        if (detail::spin_for(pred, Spins)) {
+            return true;
+        }
+        for (;;) {
+            const auto remaining = deadline - Clock::now();
+            if (remaining <= remaining.zero()) {
+                return pred();
+            }
+            const auto ns =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(remaining)
+                    .count();
+            struct timespec timeout;
+            timeout.tv_sec = static_cast<std::time_t>(ns / 1'000'000'000);
+            timeout.tv_nsec = static_cast<long>(ns % 1'000'000'000);
+            if (sleep_unless(pred, &timeout)) {
+                return true;
+            }
+        }
+    }
+
+    void notify() noexcept {
+        // Pairs with the fence in sleep_unless. Either the waiter's check
+        // sees the caller's change, or this sees the raised flag.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.load(std::memory_order_relaxed) &&
+            sleeping_.exchange(0, std::memory_order_relaxed)) {
+            epoch_.fetch_add(1, std::memory_order_release);
+            detail::futex_wake_private(epoch_);
+        }
+    }
+
+  private:
+    // Sleeps until notified, unless `pred` is already true. Returns the value
+    // of `pred()` before sleeping.
+    template <class Pred>
+    bool sleep_unless(Pred& pred, const struct timespec* timeout) {
+        sleeping_.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::uint32_t epoch = epoch_.load(std::memory_order_acquire);
+        if (pred()) {
+            return true;
+        }
+        detail::futex_wait_private(epoch_, epoch, timeout);
+        return false;
+    }
+
+    std::atomic<std::uint32_t> epoch_{0};
+    std::atomic<std::uint32_t> sleeping_{0};
+};
+
+#endif
+
+/**
+ * @brief Spins on the condition for a while, then sleeps for a fixed period
+ * between checks.
+ *
+ * The waiting thread uses almost no CPU, at the cost of up to one period of
+ * extra latency. Unlike @ref spin_futex, the producer never makes a system
+ * call.
+ *
+ * @tparam SleepMicroseconds Period between checks once spinning gives up.
+ * @tparam Spins Number of spins before the first sleep.
+ */
+template <std::size_t SleepMicroseconds = 50, std::size_t Spins = 256>
+class timed_wait {
+  public:
+    template <class Pred>
+    void wait(Pred pred) {
+        if (detail::spin_for(pred, Spins)) {
+            return;
+        }
+        while (!pred()) {
+            std::this_thread::sleep_for(period);
+        }
+    }
+
+    template <class Pred, class Clock, class Duration>
+    bool wait_until(Pred pred,
+                    const std::chrono::time_point<Clock, Duration>& deadline) {
+        if (detail::spin_for(pred, Spins)) {
+            return true;
+        }
+        while (!pred()) {
+            const auto now = Clock::now();
+            if (now >= deadline) {
+                return pred();
+            }
+            if (deadline - now < period) {
+                std::this_thread::sleep_until(deadline);
+            } else {
+                std::this_thread::sleep_for(period);
+            }
+        }
+        return true;
+    }
+
+    void notify() noexcept {}
+
+  private:
+    static constexpr std::chrono::microseconds period{SleepMicroseconds};
+};
+
+} // namespace samwarring
+
+#endif
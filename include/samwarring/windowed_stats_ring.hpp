@@ -0,0 +1,257 @@
+#ifndef INCLUDED_SAMWARRING_WINDOWED_STATS_RING_HPP
+#define INCLUDED_SAMWARRING_WINDOWED_STATS_RING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <samwarring/ring_buffer.hpp>
+#include <type_traits>
+#include <vector>
+
+namespace samwarring {
+
+namespace detail {
+
+/**
+ * @brief Candidates for the minimum (or maximum) of a sliding window.
+ *
+ * Entries are kept in window order, and their values are strictly ordered by
+ * `Compare` from front to back, so the front entry is the extreme value of
+ * the window. A new value removes every entry at the back that it beats,
+ * since those entries can never be the extreme again. Each value is pushed
+ * and popped at most once, so updates are amortized O(1).
+ *
+ * The window never holds more than `capacity` entries, so they are stored in
+ * a fixed circular array rather than a std::deque.
+ */
+template <class T, class Compare>
+class monotonic_deque {
+  public:
+    explicit monotonic_deque(std::size_t capacity) : entries_(capacity) {}
+
+    void push(std::uint64_t seq, const T& value) {
+        while (size_ && !Compare{}(entries_[index(size_ - 1)].value, value)) {
+            --size_;
+        }
+        entries_[index(size_)] = entry{seq, value};
+        ++size_;
+    }
+
+    // Drops entries that were pushed before `oldest_seq`.
+    void expire(std::uint64_t oldest_seq) {
+        while (size_ && entries_[head_].seq < oldest_seq) {
+            head_ = head_ + 1 == entries_.size() ? 0 : head_ + 1;
+            --size_;
+        }
+    }
+
+    const T& front() const noexcept {
+        return entries_[head_].value;
+    }
+
+  private:
+    struct entry {
+        std::uint64_t seq;
+        T value;
+    };
+
+    std::size_t index(std::size_t offset) const noexcept {
+        std::size_t i = head_ + offset;
+        return i >= entries_.size() ? i - entries_.size() : i;
+    }
+
+    std::vector<entry> entries_;
+    std::size_t head_{0};
+    std::size_t size_{0};
+};
+
+} // namespace detail
+
+/**
+ * @brief Sliding window of numbers with O(1) summary statistics.
+ *
+ * windowed_stats_ring keeps the last `capacity` values pushed into it in a
+ * @ref ring_buffer, and updates its statistics as values enter and leave the
+ * window, instead of rescanning the window on every query:
+ *
+ * - sum and mean come from a running sum.
+ * - variance comes from running sums of each value's deviation from a shift
+ *   value, and of its squared deviation. The shift is a value taken from the
+ *   window, so the deviations stay small even when the mean is large, and
+ *   the variance does not cancel away to rounding error.
+ * - min and max come from monotonic deques of candidate values.
+ *
+ * Every push is amortized O(1), and every query is O(1).
+ *
+ * Until `capacity` values have been pushed, the statistics describe only the
+ * values pushed so far.
+ *
+ * The running sums are recomputed from the window once every `capacity`
+ * pushes, and the shift moves to the middle value of the window. This keeps
+ * accumulated rounding error bounded, even for integers whose squares do not
+ * fit in a double exactly, while keeping the amortized cost O(1).
+ *
+ * Example
+ * -------
+ *
+ *      windowed_stats_ring<double> latencies{1000};
+ *      latencies.push_back(sample);
+ *      if (latencies.max() > 2 * latencies.mean()) {
+ *          alert();
+ *      }
+ *
+ * @tparam T Arithmetic value type.
+ */
+template <class T>
+class windowed_stats_ring {
+    static_assert(std::is_arithmetic_v<T>, "Value type is not arithmetic");
+
+  public:
+    /**
+     * @brief Type of the running sum. Integers are summed exactly in 64 bits.
+     */
+    using sum_type = std::conditional_t<
+        std::is_floating_point_v<T>, double,
+        std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>>;
+
+    /**
+     * @brief Constructs an empty window.
+     *
+     * @param capacity Number of values in the window. Must be non-zero.
+     */
+    explicit windowed_stats_ring(std::size_t capacity)
+        : window_{capacity}, min_{capacity}, max_{capacity} {}
+
+    std::size_t capacity() const noexcept {
+        return window_.capacity();
+    }
+
+    /**
+     * @return Number of values in the window, up to capacity().
+     */
+    std::size_t size() const noexcept {
+        return window_.size();
+    }
+
+    /**
+     * @brief Pushes a value into the window, evicting the oldest value if the
+     * window is full.
+     */
+    void push_back(T value) {
+        if (window_.empty()) {
+            shift_ = value;
+        }
+        if (window_.full()) {
+            const T oldest = window_.front();
+            const double d = deviation(oldest);
+            sum_ -= static_cast<sum_type>(oldest);
+            deviation_sum_ -= d;
+            deviation_sum_of_squares_ -= d * d;
+        }
+        window_.push_back(value);
+        const double d = deviation(value);
+        sum_ += static_cast<sum_type>(value);
+        deviation_sum_ += d;
+        deviation_sum_of_squares_ += d * d;
+
+        // Expire before pushing, so that each deque never holds more than
+        // `capacity` entries, even during a strictly monotonic run.
+        const std::uint64_t oldest = pushed_ + 1 - window_.size();
+        min_.expire(oldest);
+        max_.expire(oldest);
+        min_.push(pushed_, value);
+        max_.push(pushed_, value);
+        ++pushed_;
+
+        if (pushed_ % window_.capacity() == 0) {
+            recompute_sums();
+        }
+    }
+
+    /**
+     * @return Sum of the values in the window.
+     */
+    sum_type sum() const noexcept {
+        return sum_;
+    }
+
+    /**
+     * @return Arithmetic mean of the values in the window. The window must
+     * not be empty.
+     */
+    double mean() const noexcept {
+        return static_cast<double>(sum_) / static_cast<double>(size());
+    }
+
+    /**
+     * @return Population variance of the values in the window. The window
+     * must not be empty.
+     */
+    double variance() const noexcept {
+        const double n = static_cast<double>(size());
+        const double m = deviation_sum_ / n;
+        const double v = deviation_sum_of_squares_ / n - m * m;
+        return v > 0 ? v : 0;
+    }
+
+    /**
+     * @return Smallest value in the window. The window must not be empty.
+     */
+    T min() const noexcept {
+        return min_.front();
+    }
+
+    /**
+     * @return Largest value in the window. The window must not be empty.
+     */
+    T max() const noexcept {
+        return max_.front();
+    }
+
+    /**
+     * @return The underlying ring buffer, holding the values in the window.
+     */
+    const ring_buffer<T>& window() const noexcept {
+        return window_;
+    }
+
+  private:
+    // Returns `value - shift_`. For integers, the difference is taken in 64
+    // bits before it is converted, so it is exact while it fits in a double.
+    double deviation(T value) const noexcept {
+        if constexpr (std::is_floating_point_v<T>) {
+            return static_cast<double>(value) - static_cast<double>(shift_);
+        } else {
+            return static_cast<double>(static_cast<std::int64_t>(
+                static_cast<std::uint64_t>(value) -
+                static_cast<std::uint64_t>(shift_)));
+        }
+    }
+
+    void recompute_sums() noexcept {
+        shift_ = window_[window_.size() / 2];
+        sum_ = 0;
+        deviation_sum_ = 0;
+        deviation_sum_of_squares_ = 0;
+        for (T value : window_) {
+            const double d = deviation(value);
+            sum_ += value;
+            deviation_sum_ += d;
+            deviation_sum_of_squares_ += d * d;
+        }
+    }
+
+    ring_buffer<T> window_;
+    std::uint64_t pushed_{0};
+    sum_type sum_{0};
+    // Value the deviations are taken from.
+    T shift_{0};
+    double deviation_sum_{0};
+    double deviation_sum_of_squares_{0};
+    detail::monotonic_deque<T, std::less<T>> min_;
+    detail::monotonic_deque<T, std::greater<T>> max_;
+};
+
+} // namespace samwarring
+
+#endif
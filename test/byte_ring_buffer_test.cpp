@@ -0,0 +1,125 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <cstring>
+#include <samwarring/byte_ring_buffer.hpp>
+#include <samwarring/wait_strategy.hpp>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace samwarring;
+
+namespace {
+
+template <class Buffer>
+bool push_string(Buffer& buf, const std::string& s) {
+    return buf.try_push(s.data(), s.size());
+}
+
+template <class Buffer>
+std::string pop_string(Buffer& buf) {
+    auto record = buf.try_peek();
+    REQUIRE(record);
+    std::string s(record.begin(), record.end());
+    buf.release();
+    return s;
+}
+
+} // namespace
+
+TEST_CASE("byte ring buffer") {
+    byte_ring_buffer<> buf{64};
+
+    SECTION("starts empty") {
+        REQUIRE(buf.capacity() == 64);
+        REQUIRE(buf.max_record_size() == 24);
+        REQUIRE(buf.empty());
+        REQUIRE_FALSE(buf.try_peek());
+    }
+
+    SECTION("records are read in order") {
+        REQUIRE(push_string(buf, "platypus"));
+        REQUIRE(push_string(buf, "bear"));
+        REQUIRE(pop_string(buf) == "platypus");
+        REQUIRE(pop_string(buf) == "bear");
+        REQUIRE(buf.empty());
+    }
+
+    SECTION("commit may be shorter than the reservation") {
+        auto span = buf.try_reserve(20);
+        REQUIRE(span.size() == 20);
+        std::memcpy(span.data(), "abc", 3);
+        buf.commit(3);
+        REQUIRE(pop_string(buf) == "abc");
+    }
+
+    SECTION("zero-length records") {
+        REQUIRE(buf.try_push(nullptr, 0));
+        auto record = buf.try_peek();
+        REQUIRE(record);
+        REQUIRE(record.size() == 0);
+        buf.release();
+        REQUIRE(buf.empty());
+    }
+
+    SECTION("payloads are 8-byte aligned") {
+        push_string(buf, "x");
+        push_string(buf, "y");
+        for (int i = 0; i < 2; ++i) {
+            auto record = buf.try_peek();
+            REQUIRE(reinterpret_cast<std::uintptr_t>(record.data()) % 8 == 0);
+            buf.release();
+        }
+    }
+
+    SECTION("reserve fails when full") {
+        // Each 24-byte record takes 32 bytes with its header.
+        REQUIRE(push_string(buf, std::string(24, 'a')));
+        REQUIRE(push_string(buf, std::string(24, 'b')));
+        REQUIRE_FALSE(buf.try_reserve(0));
+        REQUIRE(pop_string(buf) == std::string(24, 'a'));
+        REQUIRE(buf.try_reserve(0));
+    }
+
+    SECTION("records wrap to the start of the storage") {
+        REQUIRE(push_string(buf, std::string(16, 'a'))); // Bytes [0, 24)
+        REQUIRE(pop_string(buf) == std::string(16, 'a'));
+        REQUIRE(push_string(buf, std::string(16, 'b'))); // Bytes [24, 48)
+        // Only 16 bytes remain before the end, so this record is padded to
+        // the start of the storage.
+        REQUIRE(push_string(buf, std::string(12, 'c'))); // Bytes [0, 24)
+        REQUIRE_FALSE(buf.try_reserve(0));
+        REQUIRE(pop_string(buf) == std::string(16, 'b'));
+        REQUIRE(pop_string(buf) == std::string(12, 'c'));
+        REQUIRE(buf.empty());
+    }
+
+    SECTION("oversized records are rejected") {
+        REQUIRE_THROWS_AS(buf.try_reserve(25), std::length_error);
+    }
+}
+
+TEST_CASE("threaded byte ring buffer") {
+    const int NUM_RECORDS = 50000;
+    byte_ring_buffer<spin_yield<>> buf{256};
+
+    std::thread producer{[&] {
+        for (int i = 0; i < NUM_RECORDS; ++i) {
+            const std::string s = std::to_string(i);
+            auto span = buf.reserve(s.size());
+            std::memcpy(span.data(), s.data(), s.size());
+            buf.commit(s.size());
+        }
+    }};
+
+    bool in_order = true;
+    for (int i = 0; i < NUM_RECORDS; ++i) {
+        auto record = buf.peek();
+        in_order = in_order && std::string(record.begin(), record.end()) ==
+                                   std::to_string(i);
+        buf.release();
+    }
+    producer.join();
+    REQUIRE(in_order);
+    REQUIRE(buf.empty());
+}
@@ -0,0 +1,66 @@
+#if defined(__linux__)
+
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <samwarring/memory_resource.hpp>
+#include <samwarring/ring_buffer.hpp>
+#include <stdexcept>
+
+using namespace samwarring;
+
+TEST_CASE("mapped memory resource") {
+    SECTION("allocations are page aligned") {
+        mapped_memory_resource mem;
+        void* p = mem.allocate(100);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(p) %
+                    static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE)) ==
+                0);
+        mem.deallocate(p, 100);
+    }
+
+    SECTION("huge pages fall back to regular pages") {
+        mapped_memory_resource mem{{true, -1, true}};
+        pmr::ring_buffer<std::int64_t> buf{1 << 16, &mem};
+        for (std::int64_t i = 0; i < (1 << 17); ++i) {
+            buf.push_back(i);
+        }
+        REQUIRE(buf.front() == (1 << 16));
+        REQUIRE(buf.back() == (1 << 17) - 1);
+    }
+
+    SECTION("huge page size") {
+        const std::size_t size =
+            mapped_memory_resource::default_huge_page_size();
+        REQUIRE(size >= static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)));
+        REQUIRE((size & (size - 1)) == 0);
+        REQUIRE(mapped_memory_resource{}.huge_page_size() == size);
+
+        mapped_memory_options options;
+        options.huge_page_size = std::size_t{1} << 30;
+        REQUIRE(mapped_memory_resource{options}.huge_page_size() ==
+                std::size_t{1} << 30);
+        options.huge_page_size = 3 << 20;
+        REQUIRE_THROWS_AS(mapped_memory_resource{options},
+                          std::invalid_argument);
+    }
+
+    SECTION("explicit huge page size falls back to regular pages") {
+        mapped_memory_options options;
+        options.huge_pages = true;
+        options.huge_page_size = std::size_t{1} << 30;
+        mapped_memory_resource mem{options};
+        void* p = mem.allocate(100);
+        static_cast<unsigned char*>(p)[99] = 1;
+        mem.deallocate(p, 100);
+    }
+
+    SECTION("compares equal only to itself") {
+        mapped_memory_resource a;
+        mapped_memory_resource b;
+        REQUIRE(a == a);
+        REQUIRE_FALSE(a == b);
+    }
+}
+
+#endif
@@ -0,0 +1,78 @@
+#if defined(__linux__)
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <numeric>
+#include <samwarring/mirrored_ring_buffer.hpp>
+#include <unistd.h>
+#include <vector>
+
+using namespace samwarring;
+
+TEST_CASE("mirrored ring buffer") {
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    mirrored_ring_buffer<std::int32_t> buf{10};
+
+    SECTION("capacity rounded up to whole pages") {
+        REQUIRE(buf.capacity() == page / sizeof(std::int32_t));
+    }
+
+    SECTION("starts zero-filled") {
+        REQUIRE(std::all_of(buf.begin(), buf.end(),
+                            [](std::int32_t i) { return i == 0; }));
+    }
+
+    SECTION("window is contiguous after wrapping around") {
+        const std::size_t cap = buf.capacity();
+        for (std::size_t i = 1; i <= cap + cap / 2; ++i) {
+            buf.push_back(static_cast<std::int32_t>(i));
+        }
+        REQUIRE(buf.front() == static_cast<std::int32_t>(cap / 2 + 1));
+        REQUIRE(buf.back() == static_cast<std::int32_t>(cap + cap / 2));
+
+        std::vector<std::int32_t> expected(cap);
+        std::iota(expected.begin(), expected.end(),
+                  static_cast<std::int32_t>(cap / 2 + 1));
+        REQUIRE(std::equal(buf.data(), buf.data() + cap, expected.begin()));
+    }
+
+    SECTION("bulk push across the mirror boundary") {
+        const std::size_t cap = buf.capacity();
+        std::vector<std::int32_t> items(cap - 2, 7);
+        buf.push_back(items.data(), items.size());
+        std::vector<std::int32_t> more{1, 2, 3, 4};
+        buf.push_back(more.data(), more.size());
+
+        REQUIRE(buf[cap - 4] == 1);
+        REQUIRE(buf[cap - 1] == 4);
+        REQUIRE(buf[0] == 7);
+    }
+
+    SECTION("bulk push longer than capacity") {
+        const std::size_t cap = buf.capacity();
+        std::vector<std::int32_t> items(cap + 3);
+        std::iota(items.begin(), items.end(), 0);
+        buf.push_back(items.data(), items.size());
+        REQUIRE(std::equal(buf.begin(), buf.end(), items.begin() + 3));
+    }
+
+    SECTION("move constructor") {
+        buf.push_back(42);
+        mirrored_ring_buffer<std::int32_t> buf2{std::move(buf)};
+        REQUIRE(buf.capacity() == 0);
+        REQUIRE(buf2.back() == 42);
+    }
+}
+
+TEST_CASE("mirrored ring buffer with odd-sized items") {
+    struct record {
+        char bytes[24];
+    };
+    mirrored_ring_buffer<record> buf{1};
+    REQUIRE((buf.capacity() * sizeof(record)) %
+                static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)) ==
+            0);
+}
+
+#endif
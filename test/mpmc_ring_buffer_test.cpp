@@ -0,0 +1,190 @@
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <memory>
+#include <samwarring/instance_tracker.hpp>
+#include <samwarring/mpmc_ring_buffer.hpp>
+#include <samwarring/wait_strategy.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace samwarring;
+
+TEST_CASE("mpmc ring buffer") {
+    mpmc_ring_buffer<int> queue{3};
+
+    SECTION("capacity rounded up to power of two") {
+        REQUIRE(queue.capacity() == 4);
+    }
+
+    SECTION("pop from empty queue fails") {
+        int item = -1;
+        REQUIRE_FALSE(queue.try_pop(item));
+        REQUIRE(item == -1);
+    }
+
+    SECTION("push until full") {
+        for (int i = 1; i <= 4; ++i) {
+            REQUIRE(queue.try_push(i));
+        }
+        REQUIRE_FALSE(queue.try_push(5));
+        REQUIRE(queue.size() == 4);
+
+        SECTION("pop in FIFO order") {
+            int item;
+            for (int i = 1; i <= 4; ++i) {
+                REQUIRE(queue.try_pop(item));
+                REQUIRE(item == i);
+            }
+            REQUIRE_FALSE(queue.try_pop(item));
+            REQUIRE(queue.size() == 0);
+        }
+
+        SECTION("wraps around") {
+            int item;
+            for (int i = 5; i < 20; ++i) {
+                REQUIRE(queue.try_pop(item));
+                REQUIRE(item == i - 4);
+                REQUIRE(queue.try_push(i));
+            }
+        }
+    }
+}
+
+TEST_CASE("mpmc ring buffer item lifetimes") {
+    auto stats = std::make_shared<instance_tracker_stats>();
+    {
+        mpmc_ring_buffer<instance_tracker> queue{2};
+        REQUIRE(queue.try_emplace(stats));
+        REQUIRE(queue.try_emplace(stats));
+        REQUIRE(stats->instances == 2);
+        REQUIRE(stats->all_copies == 0);
+
+        SECTION("failed push does not move from item") {
+            instance_tracker rejected{stats};
+            REQUIRE_FALSE(queue.try_push(std::move(rejected)));
+            REQUIRE(rejected.id() != 0);
+        }
+
+        SECTION("pop") {
+            instance_tracker out{stats};
+            REQUIRE(queue.try_pop(out));
+            REQUIRE(out.id() == 1);
+            REQUIRE(stats->instances == 2);
+        }
+    }
+    REQUIRE(stats->instances == 0);
+}
+
+TEST_CASE("mpmc ring buffer of capacity one") {
+    mpmc_ring_buffer<int> queue{1};
+    REQUIRE(queue.capacity() == 2);
+    REQUIRE(queue.try_push(1));
+    REQUIRE(queue.try_push(2));
+    REQUIRE_FALSE(queue.try_push(3));
+}
+
+TEST_CASE("threaded mpmc ring buffer") {
+    const int NUM_PRODUCERS = 4;
+    const int NUM_CONSUMERS = 4;
+    const int ITEMS_PER_PRODUCER = 20000;
+    mpmc_ring_buffer<int> queue{64};
+
+    std::atomic<long long> consumed_sum{0};
+    std::atomic<int> consumed_count{0};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < NUM_PRODUCERS; ++p) {
+        threads.emplace_back([&] {
+            for (int i = 1; i <= ITEMS_PER_PRODUCER; ++i) {
+                while (!queue.try_push(i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < NUM_CONSUMERS; ++c) {
+        threads.emplace_back([&] {
+            const int total = NUM_PRODUCERS * ITEMS_PER_PRODUCER;
+            while (consumed_count.load() < total) {
+                int item;
+                if (queue.try_pop(item)) {
+                    consumed_sum += item;
+                    consumed_count++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    const long long per_producer =
+        (long long)ITEMS_PER_PRODUCER * (ITEMS_PER_PRODUCER + 1) / 2;
+    REQUIRE(consumed_count == NUM_PRODUCERS * ITEMS_PER_PRODUCER);
+    REQUIRE(consumed_sum == NUM_PRODUCERS * per_producer);
+    REQUIRE(queue.size() == 0);
+}
+
+#if defined(__linux__)
+#define SAMWARRING_TEST_WAIT_STRATEGIES spin_yield<>, timed_wait<>, spin_futex<>
+#else
+#define SAMWARRING_TEST_WAIT_STRATEGIES spin_yield<>, timed_wait<>
+#endif
+
+TEMPLATE_TEST_CASE("blocking mpmc ring buffer", "",
+                   SAMWARRING_TEST_WAIT_STRATEGIES) {
+    const int NUM_PRODUCERS = 4;
+    const int NUM_CONSUMERS = 4;
+    const int ITEMS_PER_THREAD = 20000;
+    mpmc_ring_buffer<int, TestType> queue{64};
+
+    std::atomic<long long> consumed_sum{0};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < NUM_PRODUCERS; ++p) {
+        threads.emplace_back([&] {
+            for (int i = 1; i <= ITEMS_PER_THREAD; ++i) {
+                queue.push(i);
+            }
+        });
+    }
+    for (int c = 0; c < NUM_CONSUMERS; ++c) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < ITEMS_PER_THREAD; ++i) {
+                int item;
+                queue.pop(item);
+                consumed_sum += item;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    const long long per_producer =
+        (long long)ITEMS_PER_THREAD * (ITEMS_PER_THREAD + 1) / 2;
+    REQUIRE(consumed_sum == NUM_PRODUCERS * per_producer);
+    REQUIRE(queue.size() == 0);
+}
+
+TEMPLATE_TEST_CASE("mpmc ring buffer timed waits", "", busy_spin,
+                   SAMWARRING_TEST_WAIT_STRATEGIES) {
+    mpmc_ring_buffer<int, TestType> queue{2};
+    const auto timeout = std::chrono::milliseconds{5};
+    int item = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    REQUIRE_FALSE(queue.try_pop_until(item, start + timeout));
+    REQUIRE(std::chrono::steady_clock::now() - start >= timeout);
+
+    REQUIRE(queue.try_push_until(1, start + timeout));
+    REQUIRE(queue.try_push_until(3, start + timeout));
+    start = std::chrono::steady_clock::now();
+    REQUIRE_FALSE(queue.try_push_until(2, start + timeout));
+    REQUIRE(std::chrono::steady_clock::now() - start >= timeout);
+
+    REQUIRE(queue.try_pop_until(item, std::chrono::steady_clock::now()));
+    REQUIRE(item == 1);
+}
@@ -0,0 +1,134 @@
+#if defined(__linux__)
+
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <samwarring/persistent_ring_buffer.hpp>
+#include <stdexcept>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace samwarring;
+
+namespace {
+
+// Unique file path that is removed when the test ends.
+struct temp_path {
+    temp_path() {
+        static int counter = 0;
+        path = "/tmp/samwarring_persistent_ring_buffer_" +
+               std::to_string(::getpid()) + "_" + std::to_string(counter++);
+        std::remove(path.c_str());
+    }
+
+    ~temp_path() {
+        std::remove(path.c_str());
+    }
+
+    std::string path;
+};
+
+template <class Buffer>
+std::vector<std::int32_t> items(const Buffer& buf) {
+    return {buf.begin(), buf.end()};
+}
+
+} // namespace
+
+TEST_CASE("persistent ring buffer") {
+    temp_path file;
+
+    SECTION("starts empty") {
+        persistent_ring_buffer<std::int32_t> buf{file.path, 4};
+        REQUIRE(buf.empty());
+        REQUIRE(buf.capacity() == 4);
+        REQUIRE(buf.begin() == buf.end());
+    }
+
+    SECTION("overwrites the oldest item") {
+        persistent_ring_buffer<std::int32_t> buf{file.path, 4};
+        for (std::int32_t i = 1; i <= 6; ++i) {
+            buf.push_back(i);
+        }
+        REQUIRE(buf.full());
+        REQUIRE(buf.front() == 3);
+        REQUIRE(buf.back() == 6);
+        REQUIRE(items(buf) == std::vector<std::int32_t>{3, 4, 5, 6});
+    }
+
+    SECTION("reopening recovers the window") {
+        {
+            persistent_ring_buffer<std::int32_t> buf{file.path, 4};
+            for (std::int32_t i = 1; i <= 6; ++i) {
+                buf.push_back(i);
+            }
+        }
+        persistent_ring_buffer<std::int32_t> buf{file.path, 4};
+        REQUIRE(buf.generation() == 12);
+        REQUIRE(items(buf) == std::vector<std::int32_t>{3, 4, 5, 6});
+        buf.push_back(7);
+        REQUIRE(items(buf) == std::vector<std::int32_t>{4, 5, 6, 7});
+    }
+
+    SECTION("window survives a crash") {
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            persistent_ring_buffer<std::int32_t> buf{file.path, 4};
+            buf.push_back(1);
+            buf.push_back(2);
+            ::_exit(0); // No destructors run.
+        }
+        int status = 0;
+        REQUIRE(::waitpid(pid, &status, 0) == pid);
+        persistent_ring_buffer<std::int32_t> buf{file.path, 4};
+        REQUIRE(items(buf) == std::vector<std::int32_t>{1, 2});
+    }
+
+    SECTION("interrupted push drops the torn slot") {
+        {
+            persistent_ring_buffer<std::int32_t> buf{file.path, 4};
+            for (std::int32_t i = 1; i <= 5; ++i) {
+                buf.push_back(i);
+            }
+        }
+        // Simulate a crash after the generation was made odd.
+        std::FILE* f = std::fopen(file.path.c_str(), "r+b");
+        REQUIRE(f);
+        std::uint64_t generation = 11;
+        std::fseek(f, offsetof(detail::persistent_ring_header, generation),
+                   SEEK_SET);
+        std::fwrite(&generation, sizeof(generation), 1, f);
+        std::fclose(f);
+
+        persistent_ring_buffer<std::int32_t> buf{file.path, 4};
+        REQUIRE(buf.generation() == 10);
+        REQUIRE(items(buf) == std::vector<std::int32_t>{3, 4, 5});
+        buf.push_back(6);
+        REQUIRE(items(buf) == std::vector<std::int32_t>{3, 4, 5, 6});
+    }
+
+    SECTION("clear empties the file") {
+        {
+            persistent_ring_buffer<std::int32_t> buf{file.path, 4};
+            buf.push_back(1);
+            buf.clear();
+        }
+        persistent_ring_buffer<std::int32_t> buf{file.path, 4};
+        REQUIRE(buf.empty());
+    }
+
+    SECTION("rejects mismatched files") {
+        { persistent_ring_buffer<std::int32_t> buf{file.path, 4}; }
+        REQUIRE_THROWS_AS(
+            (persistent_ring_buffer<std::int32_t>{file.path, 8}),
+            std::runtime_error);
+        REQUIRE_THROWS_AS(
+            (persistent_ring_buffer<std::int16_t>{file.path, 8}),
+            std::runtime_error);
+    }
+}
+
+#endif
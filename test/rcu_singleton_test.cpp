@@ -0,0 +1,181 @@
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <memory>
+#include <samwarring/rcu_singleton.hpp>
+#include <thread>
+#include <vector>
+
+using namespace samwarring;
+
+namespace {
+
+struct settings {
+    settings() = default;
+    settings(int v) : value{v}, check{-v} {}
+    ~settings() {
+        // Poisons the object, so a reader that used it after deletion would
+        // see a mismatch.
+        value = 1;
+        check = 1;
+    }
+
+    int value{0};
+    int check{0};
+};
+
+struct tracked {
+    tracked() {
+        ++alive;
+    }
+    tracked(int v) : value{v} {
+        ++alive;
+    }
+    ~tracked() {
+        --alive;
+    }
+
+    int value{0};
+    static std::atomic<int> alive;
+};
+
+std::atomic<int> tracked::alive{0};
+
+struct basic_tag {};
+struct nested_tag {};
+struct update_tag {};
+struct thread_tag {};
+struct first_read_tag {};
+
+} // namespace
+
+TEST_CASE("rcu_singleton publish and reclaim") {
+    using rcu = rcu_singleton<tracked, basic_tag>;
+    REQUIRE(rcu::read()->value == 0);
+    const int alive = tracked::alive;
+
+    {
+        auto old_version = rcu::read();
+        rcu::emplace(1);
+        // The guard from before the publish keeps the old version.
+        REQUIRE(old_version->value == 0);
+        REQUIRE(rcu::read()->value == 1);
+        REQUIRE(rcu::retired_count() == 1);
+        REQUIRE(tracked::alive == alive + 1);
+    }
+    rcu::synchronize();
+    REQUIRE(rcu::retired_count() == 0);
+    REQUIRE(tracked::alive == alive);
+
+    // Without readers, a publish reclaims right away.
+    rcu::publish(std::make_unique<tracked>(2));
+    REQUIRE(rcu::retired_count() == 0);
+    REQUIRE(tracked::alive == alive);
+    REQUIRE(rcu::read().get()->value == 2);
+}
+
+TEST_CASE("rcu_singleton nested guards") {
+    using rcu = rcu_singleton<tracked, nested_tag>;
+    {
+        auto outer = rcu::read();
+        rcu::emplace(1);
+        {
+            auto inner = rcu::read();
+            REQUIRE(inner->value == 1);
+            rcu::emplace(2);
+        }
+        // The outer guard still protects every version since it started.
+        REQUIRE(rcu::retired_count() == 2);
+        REQUIRE(outer->value == 0);
+    }
+    rcu::synchronize();
+    REQUIRE(rcu::retired_count() == 0);
+    REQUIRE((*rcu::read()).value == 2);
+}
+
+TEST_CASE("rcu_singleton update") {
+    using rcu = rcu_singleton<settings, update_tag>;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([] {
+            for (int i = 0; i < 100; ++i) {
+                rcu::update([](settings& s) {
+                    ++s.value;
+                    s.check = -s.value;
+                });
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    REQUIRE(rcu::read()->value == 400);
+}
+
+TEST_CASE("rcu_singleton first read does not wait for a writer") {
+    using rcu = rcu_singleton<settings, first_read_tag>;
+    std::atomic<bool> updating{false};
+    std::atomic<bool> reader_done{false};
+    int read_check = 1;
+    std::thread reader{[&] {
+        while (!updating) {
+            std::this_thread::yield();
+        }
+        // The thread's first guard registers its slot while the writer below
+        // is still inside update().
+        read_check = rcu::read()->check;
+        reader_done = true;
+    }};
+
+    bool seen_during_update = false;
+    rcu::update([&](settings& s) {
+        updating = true;
+        // Gives up after a while, so that a regression fails the test
+        // instead of hanging it.
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds{10};
+        while (!reader_done && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        seen_during_update = reader_done;
+        s.value = 1;
+        s.check = -1;
+    });
+    reader.join();
+    REQUIRE(seen_during_update);
+    REQUIRE(read_check == 0);
+}
+
+TEST_CASE("rcu_singleton readers during publishes") {
+    using rcu = rcu_singleton<settings, thread_tag>;
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            int last = 0;
+            while (!done.load()) {
+                auto s = rcu::read();
+                if (s->check != -s->value || s->value < last) {
+                    ++torn;
+                }
+                last = s->value;
+                std::this_thread::yield();
+                if (s->check != -s->value) {
+                    ++torn;
+                }
+            }
+        });
+    }
+    for (int i = 1; i <= 2000; ++i) {
+        rcu::emplace(i);
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    rcu::synchronize();
+    REQUIRE(torn == 0);
+    REQUIRE(rcu::retired_count() == 0);
+    REQUIRE(rcu::read()->value == 2000);
+}
@@ -0,0 +1,34 @@
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <iterator>
+#include <ranges>
+#include <samwarring/ring_buffer.hpp>
+#include <vector>
+
+using namespace samwarring;
+
+static_assert(std::random_access_iterator<ring_buffer<int>::iterator>);
+static_assert(std::random_access_iterator<ring_buffer<int>::const_iterator>);
+static_assert(std::ranges::random_access_range<ring_buffer<int>>);
+static_assert(std::ranges::random_access_range<const ring_buffer<int>>);
+static_assert(std::ranges::sized_range<ring_buffer<int>>);
+
+TEST_CASE("ring buffer ranges") {
+    ring_buffer<int> buf{4};
+    for (int i : {9, 4, 7, 1, 8, 2}) {
+        buf.push_back(i);
+    }
+    // Window is [7, 1, 8, 2].
+
+    SECTION("ranges algorithms") {
+        std::ranges::sort(buf);
+        REQUIRE(std::ranges::equal(buf, std::vector<int>{1, 2, 7, 8}));
+        REQUIRE(std::ranges::size(buf) == 4);
+    }
+
+    SECTION("views") {
+        auto doubled = buf | std::views::reverse |
+                       std::views::transform([](int i) { return i * 2; });
+        REQUIRE(std::ranges::equal(doubled, std::vector<int>{4, 16, 2, 14}));
+    }
+}
@@ -1,7 +1,14 @@
+#include <algorithm>
 #include <catch2/catch.hpp>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <samwarring/instance_tracker.hpp>
 #include <samwarring/ring_buffer.hpp>
 #include <set>
+#include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 using namespace samwarring;
@@ -9,29 +16,58 @@ using namespace samwarring;
 TEST_CASE("ring buffer") {
     ring_buffer<int> buf{4};
 
+    SECTION("starts empty") {
+        REQUIRE(buf.empty());
+        REQUIRE(buf.size() == 0);
+        REQUIRE(buf.capacity() == 4);
+        REQUIRE(buf.begin() == buf.end());
+    }
+
     SECTION("without rollover") {
         buf.push_back(1);
         buf.push_back(2);
-        REQUIRE(buf.front() == 0);
+        REQUIRE(buf.size() == 2);
+        REQUIRE_FALSE(buf.full());
+        REQUIRE(buf.front() == 1);
         REQUIRE(buf.back() == 2);
-        REQUIRE(buf[0] == 0);
-        REQUIRE(buf[1] == 0);
-        REQUIRE(buf[2] == 1);
-        REQUIRE(buf[3] == 2);
+        REQUIRE(buf[0] == 1);
+        REQUIRE(buf[1] == 2);
 
         SECTION("iteration") {
-            std::vector<int> expected{0, 0, 1, 2};
+            std::vector<int> expected{1, 2};
+            REQUIRE(buf.end() - buf.begin() == 2);
             REQUIRE(std::equal(buf.begin(), buf.end(), expected.begin()));
         }
 
+        SECTION("partitioned iteration") {
+            std::vector<int> actual{buf.first_part().begin(),
+                                    buf.first_part().end()};
+            REQUIRE(actual == std::vector<int>{1, 2});
+            REQUIRE(buf.second_part().begin() == buf.second_part().end());
+        }
+
         SECTION("modification") {
             buf.front() = 10;
-            buf[1] = 20;
             buf.back() = 30;
             REQUIRE(buf[0] == 10);
-            REQUIRE(buf[1] == 20);
-            REQUIRE(buf[2] == 1);
-            REQUIRE(buf[3] == 30);
+            REQUIRE(buf[1] == 30);
+        }
+
+        SECTION("copy constructor") {
+            ring_buffer<int> buf2{buf};
+            buf2.push_back(3);
+            REQUIRE(buf.size() == 2);
+            REQUIRE(buf2.size() == 3);
+            REQUIRE(buf2[0] == 1);
+            REQUIRE(buf2[2] == 3);
+        }
+
+        SECTION("clear") {
+            buf.clear();
+            REQUIRE(buf.empty());
+            buf.push_back(5);
+            REQUIRE(buf.front() == 5);
+            REQUIRE(buf.size() == 1);
         }
     }
 
@@ -41,6 +77,8 @@ TEST_CASE("ring buffer") {
         buf.push_back(3);
         buf.push_back(4);
         buf.push_back(5);
+        REQUIRE(buf.full());
+        REQUIRE(buf.size() == 4);
         REQUIRE(buf.front() == 2);
         REQUIRE(buf.back() == 5);
         REQUIRE(buf[0] == 2);
@@ -150,3 +188,682 @@ TEST_CASE("const ring buffer") {
         REQUIRE(std::equal(cbuf.begin(), cbuf.end(), expected.begin()));
     }
 }
+
+TEST_CASE("power-of-two ring buffer") {
+    ring_buffer<int> buf{5, power_of_two_capacity};
+    REQUIRE(buf.capacity() == 8);
+
+    for (int i = 1; i <= 10; ++i) {
+        buf.push_back(i);
+    }
+    REQUIRE(buf.front() == 3);
+    REQUIRE(buf.back() == 10);
+    REQUIRE(buf[0] == 3);
+    REQUIRE(buf[7] == 10);
+
+    SECTION("iteration") {
+        std::vector<int> expected{3, 4, 5, 6, 7, 8, 9, 10};
+        REQUIRE(std::equal(buf.begin(), buf.end(), expected.begin()));
+    }
+
+    SECTION("copy keeps power-of-two mode") {
+        ring_buffer<int> buf2{buf};
+        buf2.push_back(11);
+        REQUIRE(buf2.capacity() == 8);
+        REQUIRE(buf2[0] == 4);
+        REQUIRE(buf2.back() == 11);
+    }
+
+    SECTION("exact power of two is not rounded") {
+        ring_buffer<int> buf2{16, power_of_two_capacity};
+        REQUIRE(buf2.capacity() == 16);
+    }
+}
+
+TEST_CASE("ring buffer bulk operations") {
+    ring_buffer<int> buf{4};
+    buf.push_back(1);
+    buf.push_back(2);
+    buf.push_back(3); // [1, 2, 3], next write at slot 3
+
+    auto contents = [&] {
+        std::vector<int> out(buf.size());
+        buf.copy_out(out.data());
+        return out;
+    };
+
+    SECTION("copy out") {
+        REQUIRE(contents() == std::vector<int>{1, 2, 3});
+    }
+
+    SECTION("push range that fits before the end") {
+        int items[] = {4};
+        buf.push_back(items, 1);
+        REQUIRE(contents() == std::vector<int>{1, 2, 3, 4});
+        REQUIRE(buf.back() == 4);
+    }
+
+    SECTION("push range that wraps around") {
+        int items[] = {4, 5, 6};
+        buf.push_back(items, 3);
+        REQUIRE(contents() == std::vector<int>{3, 4, 5, 6});
+        buf.push_back(7);
+        REQUIRE(contents() == std::vector<int>{4, 5, 6, 7});
+    }
+
+    SECTION("push range longer than capacity") {
+        std::vector<int> items{4, 5, 6, 7, 8, 9};
+        buf.push_back_range(items.begin(), items.end());
+        REQUIRE(contents() == std::vector<int>{6, 7, 8, 9});
+        buf.push_back(10);
+        REQUIRE(contents() == std::vector<int>{7, 8, 9, 10});
+    }
+
+    SECTION("push input iterator range") {
+        std::istringstream input{"4 5 6"};
+        buf.push_back_range(std::istream_iterator<int>{input},
+                            std::istream_iterator<int>{});
+        REQUIRE(contents() == std::vector<int>{3, 4, 5, 6});
+    }
+
+    SECTION("copy out to back inserter") {
+        std::vector<int> out;
+        buf.copy_out(std::back_inserter(out));
+        REQUIRE(out == std::vector<int>{1, 2, 3});
+    }
+}
+
+TEST_CASE("ring buffer of strings bulk operations") {
+    ring_buffer<std::string> buf{3};
+    std::vector<std::string> items{"poodle monkey", "platypus bear",
+                                   "tigerdillo", "flying bison"};
+    buf.push_back_range(items.begin(), items.end());
+
+    std::vector<std::string> out(3);
+    buf.copy_out(out.begin());
+    std::vector<std::string> expected{"platypus bear", "tigerdillo",
+                                      "flying bison"};
+    REQUIRE(out == expected);
+}
+
+TEST_CASE("ring buffer random access iteration") {
+    ring_buffer<int> buf{5};
+    for (int i : {40, 10, 50, 30, 20, 70, 60}) {
+        buf.push_back(i);
+    }
+    // Window is [50, 30, 20, 70, 60], wrapped after the second item.
+
+    SECTION("distance and jumps") {
+        REQUIRE(buf.end() - buf.begin() == 5);
+        auto it = buf.begin() + 3;
+        REQUIRE(*it == 70);
+        REQUIRE(it - buf.begin() == 3);
+        REQUIRE(buf.begin()[4] == 60);
+        it -= 2;
+        REQUIRE(*it == 30);
+        REQUIRE(*(2 + it) == 70);
+        REQUIRE(buf.end() - 1 == buf.begin() + 4);
+        REQUIRE(buf.begin() + 5 == buf.end());
+    }
+
+    SECTION("comparison") {
+        REQUIRE(buf.begin() < buf.end());
+        REQUIRE(buf.begin() + 4 < buf.end());
+        REQUIRE(buf.begin() + 2 > buf.begin() + 1);
+        REQUIRE(buf.begin() + 3 >= buf.begin() + 3);
+        REQUIRE(buf.begin() <= buf.begin());
+    }
+
+    SECTION("reverse iteration") {
+        std::vector<int> expected{60, 70, 20, 30, 50};
+        std::vector<int> actual{std::make_reverse_iterator(buf.end()),
+                                std::make_reverse_iterator(buf.begin())};
+        REQUIRE(actual == expected);
+    }
+
+    SECTION("sort") {
+        std::sort(buf.begin(), buf.end());
+        std::vector<int> expected{20, 30, 50, 60, 70};
+        REQUIRE(std::equal(buf.begin(), buf.end(), expected.begin()));
+
+        SECTION("binary search") {
+            auto it = std::lower_bound(buf.begin(), buf.end(), 55);
+            REQUIRE(it - buf.begin() == 3);
+        }
+    }
+
+    SECTION("nth element") {
+        auto median = buf.begin() + 2;
+        std::nth_element(buf.begin(), median, buf.end());
+        REQUIRE(*median == 50);
+    }
+
+    SECTION("const iterators") {
+        const ring_buffer<int>& cbuf = buf;
+        ring_buffer<int>::const_iterator it = buf.begin();
+        REQUIRE(it == cbuf.begin());
+        REQUIRE(cbuf.end() - it == 5);
+        REQUIRE(std::is_sorted(cbuf.begin() + 2, cbuf.begin() + 4));
+    }
+
+    SECTION("mixed iterator and const_iterator comparison") {
+        const ring_buffer<int>& cbuf = buf;
+        auto it = buf.begin();
+        REQUIRE(it == cbuf.cbegin());
+        REQUIRE(cbuf.cbegin() == it);
+        REQUIRE(it != cbuf.cend());
+        REQUIRE(it < cbuf.cend());
+        REQUIRE(cbuf.cend() > it);
+        REQUIRE(buf.end() <= cbuf.cend());
+        REQUIRE(cbuf.cbegin() >= it);
+        REQUIRE(cbuf.cend() - it == 5);
+    }
+}
+
+namespace {
+
+// Has no default constructor, and cannot be assigned.
+class immovable_sample {
+  public:
+    immovable_sample(int id, std::string name) : id_{id}, name_{name} {}
+    immovable_sample(const immovable_sample&) = default;
+    immovable_sample& operator=(const immovable_sample&) = delete;
+
+    int id() const noexcept {
+        return id_;
+    }
+
+  private:
+    int id_;
+    std::string name_;
+};
+
+} // namespace
+
+TEST_CASE("ring buffer of non-default-constructible items") {
+    ring_buffer<immovable_sample> buf{2};
+    buf.emplace_back(1, "tigerdillo");
+    buf.emplace_back(2, "flying bison");
+    auto& newest = buf.emplace_back(3, "elephant koi");
+    REQUIRE(newest.id() == 3);
+    REQUIRE(buf.front().id() == 2);
+    REQUIRE(buf.back().id() == 3);
+
+    ring_buffer<immovable_sample> buf2{buf};
+    buf2.push_back(immovable_sample{4, "platypus bear"});
+    REQUIRE(buf2.front().id() == 3);
+    REQUIRE(buf.front().id() == 2);
+}
+
+TEST_CASE("ring buffer item lifetimes") {
+    auto stats = std::make_shared<instance_tracker_stats>();
+
+    SECTION("construction creates no items") {
+        ring_buffer<instance_tracker> buf{100};
+        REQUIRE(stats->instances == 0);
+    }
+
+    SECTION("items constructed in place until full") {
+        {
+            ring_buffer<instance_tracker> buf{2};
+            buf.emplace_back(stats);
+            buf.emplace_back(stats);
+            REQUIRE(stats->instances == 2);
+            REQUIRE(stats->all_copies == 0);
+            REQUIRE(stats->all_moves == 0);
+
+            SECTION("push into full buffer move-assigns over oldest") {
+                buf.push_back(instance_tracker{stats});
+                REQUIRE(stats->instances == 2);
+                REQUIRE(stats->move_assignments == 1);
+                REQUIRE(stats->evicted_ids == std::set<int>{1});
+            }
+
+            SECTION("emplace into full buffer replaces oldest") {
+                buf.emplace_back(stats);
+                REQUIRE(stats->instances == 2);
+                REQUIRE(stats->destroyed_ids == std::set<int>{1});
+                REQUIRE(buf.back().id() == 3);
+            }
+
+            SECTION("copy constructs only live items") {
+                ring_buffer<instance_tracker> buf2{buf};
+                REQUIRE(stats->copy_constructors == 2);
+                REQUIRE(stats->copy_assignments == 0);
+            }
+        }
+        REQUIRE(stats->instances == 0);
+    }
+
+    SECTION("destroys only live items") {
+        {
+            ring_buffer<instance_tracker> buf{10};
+            buf.emplace_back(stats);
+        }
+        REQUIRE(stats->destructors == 1);
+    }
+}
+
+TEST_CASE("ring buffer emplace from its own oldest item") {
+    SECTION("emplace_back") {
+        ring_buffer<std::string> buf{2};
+        buf.push_back("a string too long for the small string buffer");
+        buf.push_back("b");
+        buf.emplace_back(buf.front());
+        REQUIRE(buf.front() == "b");
+        REQUIRE(buf.back() == "a string too long for the small string buffer");
+    }
+
+    SECTION("push_back of a non-assignable item") {
+        ring_buffer<immovable_sample> buf{2};
+        buf.emplace_back(1, "tigerdillo");
+        buf.emplace_back(2, "flying bison");
+        buf.push_back(buf.front());
+        REQUIRE(buf.front().id() == 2);
+        REQUIRE(buf.back().id() == 1);
+    }
+}
+
+TEST_CASE("ring buffer resize") {
+    ring_buffer<int> buf{5};
+    for (int i = 1; i <= 7; ++i) {
+        buf.push_back(i);
+    }
+    // Storage is [6, 7, 3, 4, 5]
+
+    auto items = [&] { return std::vector<int>(buf.begin(), buf.end()); };
+
+    SECTION("grow keeps every item") {
+        buf.resize(8);
+        REQUIRE(buf.capacity() == 8);
+        REQUIRE(items() == std::vector<int>{3, 4, 5, 6, 7});
+        for (int i = 8; i <= 11; ++i) {
+            buf.push_back(i);
+        }
+        REQUIRE(items() == std::vector<int>{4, 5, 6, 7, 8, 9, 10, 11});
+    }
+
+    SECTION("shrink keeps the newest items from both parts") {
+        buf.resize(4);
+        REQUIRE(buf.full());
+        REQUIRE(items() == std::vector<int>{4, 5, 6, 7});
+        buf.push_back(8);
+        REQUIRE(items() == std::vector<int>{5, 6, 7, 8});
+    }
+
+    SECTION("shrink keeps the newest items from the second part") {
+        buf.resize(2);
+        REQUIRE(items() == std::vector<int>{6, 7});
+    }
+
+    SECTION("shrink to fit") {
+        buf.clear();
+        buf.push_back(1);
+        buf.push_back(2);
+        buf.shrink_to_fit();
+        REQUIRE(buf.capacity() == 2);
+        REQUIRE(items() == std::vector<int>{1, 2});
+    }
+
+    SECTION("resize to zero releases the storage") {
+        buf.resize(0);
+        REQUIRE(buf.capacity() == 0);
+        REQUIRE(buf.empty());
+        buf.resize(2);
+        buf.push_back(1);
+        REQUIRE(items() == std::vector<int>{1});
+    }
+
+    SECTION("power-of-two buffers stay powers of two") {
+        ring_buffer<int> pow2{4, power_of_two_capacity};
+        pow2.resize(5);
+        REQUIRE(pow2.capacity() == 8);
+        for (int i = 0; i < 10; ++i) {
+            pow2.push_back(i);
+        }
+        REQUIRE(pow2.front() == 2);
+
+        pow2.resize(0);
+        pow2.resize(5);
+        REQUIRE(pow2.capacity() == 8);
+        pow2.resize(1);
+        REQUIRE(pow2.capacity() == 1);
+        pow2.resize(3);
+        REQUIRE(pow2.capacity() == 4);
+
+        ring_buffer<int> one{1, power_of_two_capacity};
+        REQUIRE(one.capacity() == 1);
+        one.resize(5);
+        REQUIRE(one.capacity() == 8);
+
+        // The mode travels with the storage.
+        ring_buffer<int> moved{std::move(one)};
+        moved.resize(9);
+        REQUIRE(moved.capacity() == 16);
+        ring_buffer<int> copied{moved};
+        copied.resize(17);
+        REQUIRE(copied.capacity() == 32);
+        ring_buffer<int> plain{3};
+        plain.swap(copied);
+        plain.resize(33);
+        REQUIRE(plain.capacity() == 64);
+        copied.resize(5);
+        REQUIRE(copied.capacity() == 5);
+    }
+}
+
+TEST_CASE("ring buffer resize moves items") {
+    auto stats = std::make_shared<instance_tracker_stats>();
+    {
+        ring_buffer<instance_tracker> buf{3};
+        for (int i = 0; i < 4; ++i) {
+            buf.emplace_back(stats);
+        }
+        const int moves_before = stats->move_constructors;
+        buf.resize(5);
+        REQUIRE(stats->instances == 3);
+        REQUIRE(stats->move_constructors - moves_before == 3);
+        REQUIRE(stats->copy_constructors == 0);
+        REQUIRE(buf.front().id() == 2);
+
+        buf.resize(1);
+        REQUIRE(stats->instances == 1);
+        REQUIRE(buf.front().id() == 4);
+    }
+    REQUIRE(stats->instances == 0);
+}
+
+TEST_CASE("ring buffer assignment") {
+    static_assert(std::is_nothrow_move_assignable_v<ring_buffer<std::string>>);
+
+    ring_buffer<std::string> buf{3};
+    for (const char* s : {"a", "b", "c", "d"}) {
+        buf.push_back(s);
+    }
+    ring_buffer<std::string> other{1};
+    other.push_back("x");
+
+    SECTION("copy") {
+        other = buf;
+        REQUIRE(other.capacity() == 3);
+        REQUIRE(std::equal(other.begin(), other.end(), buf.begin(),
+                           buf.end()));
+        other.push_back("e");
+        REQUIRE(other.front() == "c");
+        REQUIRE(buf.front() == "b");
+    }
+
+    SECTION("self copy") {
+        auto& alias = buf;
+        buf = alias;
+        REQUIRE(buf.front() == "b");
+    }
+
+    SECTION("move") {
+        other = std::move(buf);
+        REQUIRE(buf.capacity() == 0);
+        REQUIRE(std::vector<std::string>(other.begin(), other.end()) ==
+                std::vector<std::string>{"b", "c", "d"});
+    }
+
+    SECTION("vector growth moves buffers without copying items") {
+        auto stats = std::make_shared<instance_tracker_stats>();
+        std::vector<ring_buffer<instance_tracker>> buffers;
+        for (int i = 0; i < 10; ++i) {
+            buffers.emplace_back(2);
+            buffers.back().emplace_back(stats);
+        }
+        buffers.erase(buffers.begin());
+        REQUIRE(stats->instances == 9);
+        REQUIRE(stats->all_copies == 0);
+        REQUIRE(stats->all_moves == 0);
+    }
+}
+
+namespace {
+
+// Stateful allocator that counts the bytes it has outstanding.
+template <class T>
+struct counting_allocator {
+    using value_type = T;
+
+    explicit counting_allocator(std::shared_ptr<std::size_t> bytes)
+        : bytes{std::move(bytes)} {}
+
+    template <class U>
+    counting_allocator(const counting_allocator<U>& other) noexcept
+        : bytes{other.bytes} {}
+
+    T* allocate(std::size_t n) {
+        *bytes += n * sizeof(T);
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        *bytes -= n * sizeof(T);
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template <class U>
+    bool operator==(const counting_allocator<U>& other) const noexcept {
+        return bytes == other.bytes;
+    }
+
+    template <class U>
+    bool operator!=(const counting_allocator<U>& other) const noexcept {
+        return bytes != other.bytes;
+    }
+
+    std::shared_ptr<std::size_t> bytes;
+};
+
+} // namespace
+
+TEST_CASE("ring buffer with custom allocator") {
+    auto bytes = std::make_shared<std::size_t>(0);
+    counting_allocator<int> alloc{bytes};
+
+    {
+        ring_buffer<int, counting_allocator<int>> buf{4, alloc};
+        REQUIRE(*bytes == 4 * sizeof(int));
+        REQUIRE(buf.get_allocator() == alloc);
+        for (int i = 1; i <= 6; ++i) {
+            buf.push_back(i);
+        }
+
+        SECTION("copy uses the same allocator") {
+            auto copy = buf;
+            REQUIRE(*bytes == 8 * sizeof(int));
+            REQUIRE(std::equal(copy.begin(), copy.end(), buf.begin(),
+                               buf.end()));
+        }
+
+        SECTION("move with an equal allocator steals the storage") {
+            ring_buffer<int, counting_allocator<int>> moved{std::move(buf),
+                                                            alloc};
+            REQUIRE(*bytes == 4 * sizeof(int));
+            REQUIRE(buf.capacity() == 0);
+            REQUIRE(moved.front() == 3);
+        }
+
+        SECTION("move with another allocator moves the items") {
+            auto other_bytes = std::make_shared<std::size_t>(0);
+            counting_allocator<int> other{other_bytes};
+            ring_buffer<int, counting_allocator<int>> moved{std::move(buf),
+                                                            other};
+            REQUIRE(*bytes == 0);
+            REQUIRE(*other_bytes == 4 * sizeof(int));
+            REQUIRE(buf.capacity() == 0);
+            REQUIRE(std::vector<int>(moved.begin(), moved.end()) ==
+                    std::vector<int>{3, 4, 5, 6});
+        }
+
+        SECTION("assignment keeps the allocator") {
+            auto other_bytes = std::make_shared<std::size_t>(0);
+            counting_allocator<int> other{other_bytes};
+            ring_buffer<int, counting_allocator<int>> assigned{2, other};
+
+            assigned = buf;
+            REQUIRE(assigned.get_allocator() == other);
+            REQUIRE(*other_bytes == 4 * sizeof(int));
+
+            assigned = std::move(buf);
+            REQUIRE(*bytes == 0);
+            REQUIRE(*other_bytes == 4 * sizeof(int));
+            REQUIRE(std::vector<int>(assigned.begin(), assigned.end()) ==
+                    std::vector<int>{3, 4, 5, 6});
+        }
+
+        SECTION("resize uses the allocator") {
+            buf.resize(10);
+            REQUIRE(*bytes == 10 * sizeof(int));
+            REQUIRE(buf.front() == 3);
+        }
+    }
+    REQUIRE(*bytes == 0);
+}
+
+TEST_CASE("pmr ring buffer") {
+    alignas(std::max_align_t) unsigned char storage[4096];
+    std::pmr::monotonic_buffer_resource arena{
+        storage, sizeof(storage), std::pmr::null_memory_resource()};
+
+    SECTION("storage comes from the arena") {
+        pmr::ring_buffer<int> buf{16, &arena};
+        REQUIRE(buf.get_allocator().resource() == &arena);
+        for (int i = 0; i < 20; ++i) {
+            buf.push_back(i);
+        }
+        REQUIRE(buf.front() == 4);
+        REQUIRE(buf.back() == 19);
+    }
+
+    SECTION("items use the buffer's allocator") {
+        pmr::ring_buffer<std::pmr::string> buf{2, &arena};
+        buf.emplace_back("a string too long for the small string buffer");
+        REQUIRE(buf.back().get_allocator().resource() == &arena);
+
+        SECTION("copies keep the default resource") {
+            auto copy = buf;
+            REQUIRE(copy.get_allocator().resource() ==
+                    std::pmr::get_default_resource());
+            REQUIRE(copy.back().get_allocator().resource() ==
+                    std::pmr::get_default_resource());
+        }
+    }
+}
+
+TEST_CASE("ring buffer pop_front and swap") {
+    ring_buffer<std::string> a{3};
+    for (const char* s : {"a", "b", "c", "d"}) {
+        a.push_back(s);
+    }
+    a.pop_front();
+    REQUIRE(a.size() == 2);
+    REQUIRE(a.front() == "c");
+    a.push_back("e");
+    REQUIRE(std::vector<std::string>(a.begin(), a.end()) ==
+            std::vector<std::string>{"c", "d", "e"});
+
+    ring_buffer<std::string> b{5};
+    b.push_back("x");
+    swap(a, b);
+    REQUIRE(a.capacity() == 5);
+    REQUIRE(a.size() == 1);
+    REQUIRE(a.front() == "x");
+    REQUIRE(b.capacity() == 3);
+    REQUIRE(std::vector<std::string>(b.begin(), b.end()) ==
+            std::vector<std::string>{"c", "d", "e"});
+}
+
+TEST_CASE("ring buffer pop_front") {
+    ring_buffer<std::string> buf{4};
+    for (const char* s : {"a", "b", "c"}) {
+        buf.push_back(s);
+    }
+    buf.pop_front();
+    buf.pop_front();
+
+    auto items = [](const ring_buffer<std::string>& b) {
+        return std::vector<std::string>(b.begin(), b.end());
+    };
+    auto unordered_items = [](const ring_buffer<std::string>& b) {
+        return std::multiset<std::string>(b.unordered_begin(),
+                                          b.unordered_end());
+    };
+
+    SECTION("unordered iteration skips popped slots") {
+        REQUIRE(unordered_items(buf) == std::multiset<std::string>{"c"});
+    }
+
+    SECTION("unordered iteration skips the gap once items wrap") {
+        for (const char* s : {"d", "e", "f"}) {
+            buf.push_back(s);
+        }
+        buf.pop_front();
+        // Storage is [e, f, _, d], with the gap left by popping "c".
+        REQUIRE(items(buf) == std::vector<std::string>{"d", "e", "f"});
+        REQUIRE(unordered_items(buf) ==
+                std::multiset<std::string>{"d", "e", "f"});
+        std::vector<std::string> visited;
+        for (auto it = buf.unordered_begin(); it != buf.unordered_end();
+             ++it) {
+            visited.push_back(*it += "!");
+        }
+        REQUIRE(visited == std::vector<std::string>{"e!", "f!", "d!"});
+        REQUIRE(items(buf) == std::vector<std::string>{"d!", "e!", "f!"});
+    }
+
+    SECTION("unordered iteration of a full buffer after pop_front") {
+        for (const char* s : {"d", "e", "f"}) {
+            buf.push_back(s);
+        }
+        buf.pop_front();
+        buf.push_back("g");
+        REQUIRE(buf.full());
+        REQUIRE(unordered_items(buf) ==
+                std::multiset<std::string>{"d", "e", "f", "g"});
+    }
+
+    SECTION("copy after pop_front") {
+        buf.push_back("d");
+        buf.push_back("e");
+        buf.pop_front();
+        ring_buffer<std::string> copy{buf};
+        REQUIRE(items(copy) == std::vector<std::string>{"d", "e"});
+        REQUIRE(unordered_items(copy) ==
+                std::multiset<std::string>{"d", "e"});
+
+        ring_buffer<std::string> assigned{2};
+        assigned.push_back("x");
+        assigned = buf;
+        REQUIRE(items(assigned) == std::vector<std::string>{"d", "e"});
+        assigned.push_back("f");
+        assigned.push_back("g");
+        assigned.push_back("h");
+        REQUIRE(items(assigned) ==
+                std::vector<std::string>{"e", "f", "g", "h"});
+    }
+
+    SECTION("resize after pop_front") {
+        for (const char* s : {"d", "e", "f"}) {
+            buf.push_back(s);
+        }
+        buf.pop_front();
+        buf.resize(3);
+        REQUIRE(items(buf) == std::vector<std::string>{"d", "e", "f"});
+        REQUIRE(buf.full());
+        buf.pop_front();
+        buf.resize(8);
+        REQUIRE(items(buf) == std::vector<std::string>{"e", "f"});
+        REQUIRE(unordered_items(buf) ==
+                std::multiset<std::string>{"e", "f"});
+    }
+
+    SECTION("popping every item") {
+        buf.pop_front();
+        REQUIRE(buf.empty());
+        REQUIRE(buf.unordered_begin() == buf.unordered_end());
+        REQUIRE(buf.begin() == buf.end());
+    }
+}
@@ -0,0 +1,102 @@
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <samwarring/seqlock_ring_buffer.hpp>
+#include <thread>
+#include <vector>
+
+using namespace samwarring;
+
+TEST_CASE("seqlock ring buffer from one thread") {
+    seqlock_ring_buffer<int> ring{3};
+    REQUIRE(ring.capacity() == 4);
+    REQUIRE(ring.head() == 0);
+    REQUIRE(ring.snapshot().empty());
+
+    int value = -1;
+    REQUIRE_FALSE(ring.try_read(0, value));
+
+    for (int i = 0; i < 6; ++i) {
+        ring.push_back(i * 10);
+    }
+    REQUIRE(ring.head() == 6);
+    REQUIRE(ring.snapshot() == std::vector<int>{20, 30, 40, 50});
+
+    REQUIRE(ring.try_read(5, value));
+    REQUIRE(value == 50);
+    REQUIRE_FALSE(ring.try_read(1, value));
+    REQUIRE_FALSE(ring.try_read(6, value));
+
+    SECTION("read a range") {
+        int out[4] = {};
+        auto r = ring.read(3, 5, out);
+        REQUIRE(r.first == 3);
+        REQUIRE(r.count == 2);
+        REQUIRE(out[0] == 30);
+        REQUIRE(out[1] == 40);
+    }
+
+    SECTION("read a range partly overwritten") {
+        int out[6] = {};
+        auto r = ring.read(0, 6, out);
+        REQUIRE(r.first == 2);
+        REQUIRE(r.count == 4);
+        REQUIRE(out[0] == 20);
+        REQUIRE(out[3] == 50);
+    }
+
+    SECTION("read a range not pushed yet") {
+        int out[4] = {};
+        auto r = ring.read(5, 9, out);
+        REQUIRE(r.first == 5);
+        REQUIRE(r.count == 1);
+        REQUIRE(out[0] == 50);
+        REQUIRE(ring.read(7, 9, out).count == 0);
+    }
+}
+
+namespace {
+
+// Every word holds the item's position, so a torn copy has mismatched words.
+struct wide_item {
+    std::uint64_t words[5];
+};
+
+} // namespace
+
+TEST_CASE("seqlock ring buffer readers never see torn items") {
+    const std::uint64_t PUSHES = 200'000;
+    seqlock_ring_buffer<wide_item> ring{64};
+    std::atomic<bool> done{false};
+    std::atomic<bool> consistent{true};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                auto items = ring.snapshot();
+                for (std::size_t i = 0; i < items.size(); ++i) {
+                    for (std::uint64_t w : items[i].words) {
+                        if (w != items[0].words[0] + i) {
+                            consistent = false;
+                        }
+                    }
+                }
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    for (std::uint64_t i = 0; i < PUSHES; ++i) {
+        ring.push_back(wide_item{{i, i, i, i, i}});
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    REQUIRE(consistent);
+
+    auto items = ring.snapshot();
+    REQUIRE(items.size() == 64);
+    REQUIRE(items.back().words[4] == PUSHES - 1);
+}
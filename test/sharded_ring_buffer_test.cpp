@@ -0,0 +1,98 @@
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <samwarring/sharded_ring_buffer.hpp>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace samwarring;
+
+TEST_CASE("sharded ring buffer from one thread") {
+    sharded_ring_buffer<int> ring{5, 3};
+    REQUIRE(ring.shard_count() == 3);
+    REQUIRE(ring.capacity_per_shard() == 5);
+    REQUIRE(ring.size() == 0);
+
+    for (int i = 1; i <= 10; ++i) {
+        ring.push_back(i);
+    }
+    REQUIRE(ring.size() == 5);
+
+    std::vector<int> values;
+    for (const auto& e : ring.snapshot()) {
+        values.push_back(e.value);
+    }
+    REQUIRE(values == std::vector<int>{6, 7, 8, 9, 10});
+
+    ring.clear();
+    REQUIRE(ring.size() == 0);
+    REQUIRE(ring.snapshot().empty());
+}
+
+TEST_CASE("sharded ring buffer merges shards in stamp order") {
+    const int THREADS = 4;
+    const int PUSHES = 1000;
+
+    // Every thread could land in the same shard, so each shard holds them
+    // all and nothing is overwritten.
+    sharded_ring_buffer<std::pair<int, int>> ring{THREADS * PUSHES, THREADS};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&ring, t] {
+            for (int i = 0; i < PUSHES; ++i) {
+                ring.emplace_back(t, i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto merged = ring.snapshot();
+    REQUIRE(merged.size() == THREADS * PUSHES);
+
+    bool ordered = true;
+    std::vector<int> next(THREADS, 0);
+    for (std::size_t i = 0; i < merged.size(); ++i) {
+        if (i > 0 && merged[i - 1].stamp > merged[i].stamp) {
+            ordered = false;
+        }
+        auto [t, seq] = merged[i].value;
+        if (seq != next[t]++) {
+            ordered = false;
+        }
+    }
+    REQUIRE(ordered);
+
+    std::size_t visited = 0;
+    ring.for_each([&](const auto&) { ++visited; });
+    REQUIRE(visited == merged.size());
+}
+
+TEST_CASE("sharded ring buffer rejects zero sizes") {
+    REQUIRE_THROWS_AS(sharded_ring_buffer<int>(0, 2), std::invalid_argument);
+    REQUIRE_THROWS_AS(sharded_ring_buffer<int>(2, 0), std::invalid_argument);
+}
+
+TEST_CASE("cache-aligned shard storage") {
+    detail::cache_aligned_allocator<char> alloc;
+    for (std::size_t n : {1, 3, 64, 65, 1000}) {
+        char* p = alloc.allocate(n);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(p) %
+                    detail::cache_line_size ==
+                0);
+        alloc.deallocate(p, n);
+    }
+
+    ring_buffer<int, detail::cache_aligned_allocator<int>> ring{3};
+    REQUIRE(reinterpret_cast<std::uintptr_t>(&*ring.first_part().begin()) %
+                detail::cache_line_size ==
+            0);
+    for (int i = 0; i < 5; ++i) {
+        ring.push_back(i);
+    }
+    REQUIRE(std::vector<int>(ring.begin(), ring.end()) ==
+            std::vector<int>{2, 3, 4});
+}
@@ -0,0 +1,172 @@
+#if defined(__linux__)
+
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <samwarring/shm_spsc_ring_buffer.hpp>
+#include <stdexcept>
+#include <string>
+#include <sys/wait.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace samwarring;
+
+namespace {
+
+struct record {
+    std::uint64_t seq;
+    double value;
+};
+
+// Unique segment name that is removed when the test ends.
+struct temp_segment {
+    temp_segment()
+        : name{"/samwarring_shm_spsc_test_" + std::to_string(::getpid())} {
+        shm_spsc_ring_buffer<record>::remove(name);
+    }
+
+    ~temp_segment() {
+        shm_spsc_ring_buffer<record>::remove(name);
+    }
+
+    std::string name;
+};
+
+} // namespace
+
+TEST_CASE("shm spsc ring buffer") {
+    temp_segment segment;
+    shm_spsc_ring_buffer<record> producer{segment.name, 3};
+
+    SECTION("capacity rounded up to a power of two") {
+        REQUIRE(producer.capacity() == 4);
+        REQUIRE(producer.empty());
+    }
+
+    SECTION("records are written and read in place") {
+        shm_spsc_ring_buffer<record> consumer{segment.name};
+        REQUIRE(consumer.capacity() == 4);
+        REQUIRE(consumer.try_peek() == nullptr);
+
+        record* slot = producer.try_reserve();
+        REQUIRE(slot);
+        *slot = record{1, 1.5};
+        REQUIRE(consumer.try_peek() == nullptr); // Not committed yet.
+        producer.commit();
+
+        const record* front = consumer.try_peek();
+        REQUIRE(front);
+        REQUIRE(front->seq == 1);
+        REQUIRE(front->value == 1.5);
+        consumer.release();
+        REQUIRE(consumer.empty());
+    }
+
+    SECTION("push fails when full") {
+        shm_spsc_ring_buffer<record> consumer{segment.name};
+        for (std::uint64_t i = 0; i < 4; ++i) {
+            REQUIRE(producer.try_push(record{i, 0}));
+        }
+        REQUIRE_FALSE(producer.try_push(record{4, 0}));
+        REQUIRE(producer.size() == 4);
+
+        record r;
+        REQUIRE(consumer.try_pop(r));
+        REQUIRE(r.seq == 0);
+        REQUIRE(producer.try_push(record{4, 0}));
+        for (std::uint64_t i = 1; i <= 4; ++i) {
+            REQUIRE(consumer.try_pop(r));
+            REQUIRE(r.seq == i);
+        }
+        REQUIRE_FALSE(consumer.try_pop(r));
+    }
+
+    SECTION("batch consumer reads both spans in place") {
+        shm_spsc_ring_buffer<record> consumer{segment.name};
+        for (std::uint64_t i = 0; i < 3; ++i) {
+            producer.push(record{i, 0});
+        }
+        REQUIRE(consumer.consume_batch(2, [](const record*, const record*) {
+        }) == 2);
+        for (std::uint64_t i = 3; i < 6; ++i) {
+            producer.push(record{i, 0});
+        }
+
+        std::vector<std::uint64_t> seqs;
+        std::size_t spans = 0;
+        REQUIRE(consumer.consume_batch(
+                    10, [&](const record* begin, const record* end) {
+                        ++spans;
+                        for (; begin != end; ++begin) {
+                            seqs.push_back(begin->seq);
+                        }
+                    }) == 4);
+        REQUIRE(spans == 2);
+        REQUIRE(seqs == std::vector<std::uint64_t>{2, 3, 4, 5});
+        REQUIRE(consumer.empty());
+    }
+
+    SECTION("name cannot be created twice") {
+        REQUIRE_THROWS_AS((shm_spsc_ring_buffer<record>{segment.name, 4}),
+                          std::system_error);
+    }
+
+    SECTION("rejects another record type") {
+        REQUIRE_THROWS_AS((shm_spsc_ring_buffer<std::uint32_t>{segment.name}),
+                          std::runtime_error);
+    }
+
+    SECTION("records pass between processes in order") {
+        const std::uint64_t count = 100'000;
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            int status = 0;
+            try {
+                shm_spsc_ring_buffer<record> consumer{segment.name};
+                for (std::uint64_t i = 0; i < count; ++i) {
+                    record r = consumer.pop();
+                    if (r.seq != i || r.value != static_cast<double>(i)) {
+                        status = 1;
+                    }
+                }
+            } catch (...) {
+                status = 2;
+            }
+            ::_exit(status);
+        }
+        // Pushes without blocking, so that a consumer that crashed or got
+        // stuck fails the test instead of hanging it.
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds{30};
+        int status = -1;
+        bool exited_early = false;
+        bool timed_out = false;
+        for (std::uint64_t i = 0; i < count && !exited_early && !timed_out;) {
+            if (producer.try_push(record{i, static_cast<double>(i)})) {
+                ++i;
+            } else if (::waitpid(pid, &status, WNOHANG) == pid) {
+                exited_early = true;
+            } else if (std::chrono::steady_clock::now() > deadline) {
+                timed_out = true;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        if (timed_out) {
+            ::kill(pid, SIGKILL);
+        }
+        if (!exited_early) {
+            REQUIRE(::waitpid(pid, &status, 0) == pid);
+        }
+        REQUIRE_FALSE(timed_out);
+        REQUIRE_FALSE(exited_early);
+        REQUIRE(WIFEXITED(status));
+        REQUIRE(WEXITSTATUS(status) == 0);
+    }
+}
+
+#endif
@@ -0,0 +1,126 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <samwarring/ring_buffer.hpp>
+#include <samwarring/simd_kernels.hpp>
+#include <vector>
+
+using namespace samwarring;
+
+namespace {
+
+template <class T>
+std::vector<T> random_values(std::size_t n) {
+    std::mt19937 rng{99};
+    std::vector<T> values(n);
+    for (auto& v : values) {
+        if constexpr (std::is_floating_point_v<T>) {
+            v = std::uniform_real_distribution<T>{-100, 100}(rng);
+        } else {
+            v = std::uniform_int_distribution<T>{-1000000, 1000000}(rng);
+        }
+    }
+    return values;
+}
+
+// Compares every instruction set this CPU supports against the scalar
+// kernels, for lengths that exercise both the vector loop and the tail.
+template <class T>
+void check_kernels_agree() {
+    auto data = random_values<T>(103);
+    auto kernel = random_values<T>(103);
+    const T threshold = data[7];
+    namespace d = simd::detail;
+
+    for (std::size_t n : {1, 3, 8, 17, 64, 103}) {
+        auto expected_sum = d::scalar::sum(data.data(), n);
+        auto expected_min_max = d::scalar::min_max(data.data(), n);
+        auto expected_dot = d::scalar::dot(data.data(), kernel.data(), n);
+        auto expected_count =
+            d::scalar::count_greater(data.data(), n, threshold);
+
+        REQUIRE(simd::sum(data.data(), n) == Approx(expected_sum));
+        REQUIRE(simd::min_max(data.data(), n) == expected_min_max);
+        REQUIRE(simd::dot(data.data(), kernel.data(), n) ==
+                Approx(expected_dot));
+        REQUIRE(simd::count_greater(data.data(), n, threshold) ==
+                expected_count);
+
+#if SAMWARRING_SIMD_X86
+        REQUIRE(d::sse2::sum(data.data(), n) == Approx(expected_sum));
+        REQUIRE(d::sse2::min_max(data.data(), n) == expected_min_max);
+        REQUIRE(d::sse2::dot(data.data(), kernel.data(), n) ==
+                Approx(expected_dot));
+        REQUIRE(d::sse2::count_greater(data.data(), n, threshold) ==
+                expected_count);
+
+        if (simd::best_instruction_set() == simd::instruction_set::avx2) {
+            REQUIRE(d::avx2::sum(data.data(), n) == Approx(expected_sum));
+            REQUIRE(d::avx2::min_max(data.data(), n) == expected_min_max);
+            REQUIRE(d::avx2::dot(data.data(), kernel.data(), n) ==
+                    Approx(expected_dot));
+            REQUIRE(d::avx2::count_greater(data.data(), n, threshold) ==
+                    expected_count);
+        }
+#endif
+    }
+}
+
+} // namespace
+
+TEST_CASE("simd kernels agree with scalar kernels") {
+    SECTION("float") {
+        check_kernels_agree<float>();
+    }
+    SECTION("double") {
+        check_kernels_agree<double>();
+    }
+    SECTION("int32") {
+        check_kernels_agree<std::int32_t>();
+    }
+}
+
+TEST_CASE("simd kernels over ring buffer") {
+    ring_buffer<std::int32_t> buf{20};
+    for (std::int32_t i = 1; i <= 27; ++i) {
+        buf.push_back(i);
+    }
+    // Window is [8, 9, ..., 27], split across both partitions.
+    std::vector<std::int32_t> window(buf.begin(), buf.end());
+
+    SECTION("sum") {
+        REQUIRE(simd::sum(buf) ==
+                std::accumulate(window.begin(), window.end(), 0));
+    }
+
+    SECTION("min max") {
+        REQUIRE(simd::min_max(buf) == std::make_pair(8, 27));
+    }
+
+    SECTION("dot product aligns kernel with front of window") {
+        std::vector<std::int32_t> kernel(20, 0);
+        kernel[0] = 1;
+        kernel[19] = 1000;
+        REQUIRE(simd::dot(buf, kernel.data()) == 8 + 27 * 1000);
+    }
+
+    SECTION("count over threshold") {
+        REQUIRE(simd::count_greater(buf, 20) == 7);
+    }
+
+    SECTION("without wraparound") {
+        ring_buffer<std::int32_t> unwrapped{20};
+        for (std::int32_t i = 1; i <= 20; ++i) {
+            unwrapped.push_back(i);
+        }
+        REQUIRE(simd::min_max(unwrapped) == std::make_pair(1, 20));
+    }
+}
+
+TEST_CASE("simd kernels on non-vectorized types") {
+    std::vector<std::int16_t> values{3, -7, 12, 5};
+    REQUIRE(simd::sum(values.data(), values.size()) == 13);
+    REQUIRE(simd::min_max(values.data(), values.size()) ==
+            std::make_pair<std::int16_t, std::int16_t>(-7, 12));
+}
@@ -0,0 +1,206 @@
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <mutex>
+#include <samwarring/singleton_registry.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace samwarring;
+
+namespace {
+
+// Records construction and destruction order across every test type.
+std::mutex events_mtx;
+std::vector<std::string> events;
+
+void record(std::string event) {
+    std::lock_guard<std::mutex> lk{events_mtx};
+    events.push_back(std::move(event));
+}
+
+struct config {
+    config() {
+        record("+config");
+    }
+    ~config() {
+        record("-config");
+    }
+    int port{8080};
+};
+
+struct logger {
+    logger() : port{singleton_registry::get<config>().port} {
+        record("+logger");
+    }
+    ~logger() {
+        // The config must still be alive.
+        port = singleton_registry::get<config>().port;
+        record("-logger");
+    }
+    int port;
+};
+
+struct database {
+    database() {
+        REQUIRE(singleton_registry::find<config>() != nullptr);
+        REQUIRE(singleton_registry::find<logger>() != nullptr);
+        record("+database");
+    }
+    ~database() {
+        record("-database");
+    }
+};
+
+struct first_tag {};
+struct second_tag {};
+
+struct failing {
+    failing() {
+        throw std::runtime_error{"failing"};
+    }
+};
+
+struct counted {
+    counted() {
+        ++instances;
+    }
+    ~counted() {
+        --instances;
+    }
+    static std::atomic<int> instances;
+};
+
+std::atomic<int> counted::instances{0};
+
+template <int N>
+struct leaf : counted {};
+
+} // namespace
+
+TEST_CASE("singleton_registry warm_up and tear_down order") {
+    events.clear();
+    {
+        singleton_registry registry;
+        // Registered out of order on purpose.
+        registry.add<database>(singleton_key<logger>{},
+                               singleton_key<config>{});
+        registry.add<logger>(singleton_key<config>{});
+        registry.add<config>();
+        REQUIRE_FALSE(registry.warm());
+        REQUIRE(singleton_registry::find<config>() == nullptr);
+
+        registry.warm_up();
+        REQUIRE(registry.warm());
+        REQUIRE(singleton_registry::get<logger>().port == 8080);
+        REQUIRE(&singleton_registry::get<config>() ==
+                singleton_registry::find<config>());
+
+        // Warming up again does nothing.
+        registry.warm_up();
+        REQUIRE(events.size() == 3);
+    }
+    REQUIRE(singleton_registry::find<config>() == nullptr);
+    REQUIRE(singleton_registry::find<logger>() == nullptr);
+    REQUIRE(singleton_registry::find<database>() == nullptr);
+    REQUIRE(events == std::vector<std::string>{"+config", "+logger",
+                                               "+database", "-database",
+                                               "-logger", "-config"});
+}
+
+TEST_CASE("singleton_registry tear_down and warm_up again") {
+    events.clear();
+    singleton_registry registry;
+    registry.add<config>();
+    registry.warm_up(1);
+    registry.tear_down();
+    REQUIRE_FALSE(registry.warm());
+    REQUIRE(singleton_registry::find<config>() == nullptr);
+    registry.warm_up(1);
+    REQUIRE(singleton_registry::find<config>() != nullptr);
+    registry.tear_down();
+    REQUIRE(events == std::vector<std::string>{"+config", "-config",
+                                               "+config", "-config"});
+}
+
+TEST_CASE("singleton_registry tags") {
+    singleton_registry registry;
+    registry.add<counted, first_tag>();
+    registry.add<counted, second_tag>(singleton_key<counted, first_tag>{});
+    registry.warm_up();
+    REQUIRE(counted::instances == 2);
+    REQUIRE(&singleton_registry::get<counted, first_tag>() !=
+            &singleton_registry::get<counted, second_tag>());
+    REQUIRE(singleton_registry::find<counted>() == nullptr);
+    registry.tear_down();
+    REQUIRE(counted::instances == 0);
+}
+
+TEST_CASE("singleton_registry parallel level") {
+    singleton_registry registry;
+    registry.add<leaf<0>>();
+    registry.add<leaf<1>>();
+    registry.add<leaf<2>>();
+    registry.add<leaf<3>>();
+    registry.add<leaf<4>>(singleton_key<leaf<0>>{}, singleton_key<leaf<1>>{},
+                          singleton_key<leaf<2>>{}, singleton_key<leaf<3>>{});
+    registry.warm_up(4);
+    REQUIRE(counted::instances == 5);
+    registry.tear_down();
+    REQUIRE(counted::instances == 0);
+}
+
+TEST_CASE("singleton_registry errors") {
+    SECTION("duplicate") {
+        singleton_registry registry;
+        registry.add<config>();
+        REQUIRE_THROWS_AS(registry.add<config>(), std::invalid_argument);
+    }
+
+    SECTION("missing dependency") {
+        singleton_registry registry;
+        registry.add<logger>(singleton_key<config>{});
+        REQUIRE_THROWS_AS(registry.warm_up(), std::invalid_argument);
+        REQUIRE_FALSE(registry.warm());
+    }
+
+    SECTION("cycle") {
+        singleton_registry registry;
+        registry.add<leaf<0>>(singleton_key<leaf<1>>{});
+        registry.add<leaf<1>>(singleton_key<leaf<0>>{});
+        registry.add<leaf<2>>();
+        REQUIRE_THROWS_AS(registry.warm_up(), std::logic_error);
+        REQUIRE(counted::instances == 0);
+    }
+
+    SECTION("add after warm_up") {
+        singleton_registry registry;
+        registry.add<leaf<0>>();
+        registry.warm_up();
+        REQUIRE_THROWS_AS(registry.add<leaf<1>>(), std::logic_error);
+    }
+
+    SECTION("constructed by another registry") {
+        singleton_registry first;
+        singleton_registry second;
+        first.add<leaf<0>>();
+        second.add<leaf<0>>();
+        first.warm_up();
+        REQUIRE_THROWS_AS(second.warm_up(), std::logic_error);
+        REQUIRE(singleton_registry::find<leaf<0>>() != nullptr);
+    }
+
+    SECTION("constructor throws") {
+        singleton_registry registry;
+        registry.add<leaf<0>>();
+        registry.add<leaf<1>>();
+        registry.add<failing>(singleton_key<leaf<0>>{});
+        registry.add<leaf<2>>(singleton_key<failing>{});
+        REQUIRE_THROWS_AS(registry.warm_up(), std::runtime_error);
+        REQUIRE_FALSE(registry.warm());
+        REQUIRE(singleton_registry::find<leaf<0>>() == nullptr);
+        REQUIRE(singleton_registry::find<leaf<2>>() == nullptr);
+    }
+
+    REQUIRE(counted::instances == 0);
+}
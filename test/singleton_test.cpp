@@ -1,8 +1,10 @@
 #include <atomic>
 #include <catch2/catch.hpp>
 #include <iostream>
+#include <memory>
 #include <samwarring/singleton.hpp>
 #include <sstream>
+#include <stdexcept>
 #include <thread>
 #include <vector>
 
@@ -148,4 +150,157 @@ TEST_CASE("threaded reference counted singleton") {
     for (auto& t : threads) {
         t.join();
     }
-}
\ No newline at end of file
+}
+
+class singleton_tag_threads {};
+
+TEST_CASE("reference counted singleton shared between threads") {
+    auto get = [] {
+        return reference_counted_singleton<rc_singleton_test_class,
+                                           singleton_tag_threads>();
+    };
+
+    auto handle = get();
+    std::shared_ptr<rc_singleton_test_class> from_worker;
+    std::thread{[&] { from_worker = get(); }}.join();
+    REQUIRE(from_worker == handle);
+
+    // This thread's cached pointer expires with the first object, and must
+    // not keep returning it once another thread has made a new one.
+    handle.reset();
+    from_worker.reset();
+    REQUIRE(rc_singleton_test_class::instances() == 0);
+    std::thread{[&] { from_worker = get(); }}.join();
+    REQUIRE(rc_singleton_test_class::instances() == 1);
+    REQUIRE(get() == from_worker);
+    from_worker.reset();
+    REQUIRE(rc_singleton_test_class::instances() == 0);
+}
+
+// Throws from its constructor on the first attempt only.
+class flaky_singleton {
+  public:
+    flaky_singleton() {
+        if (attempts_++ == 0) {
+            throw std::runtime_error{"first construction fails"};
+        }
+    }
+
+  private:
+    static int attempts_;
+};
+
+int flaky_singleton::attempts_{0};
+
+TEST_CASE("reference counted singleton after a failed construction") {
+    REQUIRE_THROWS_AS(reference_counted_singleton<flaky_singleton>(),
+                      std::runtime_error);
+    auto handle = reference_counted_singleton<flaky_singleton>();
+    REQUIRE(handle);
+}
+
+class singleton_tag_borrowed {};
+
+TEST_CASE("borrowed singleton") {
+    using borrowed =
+        borrowed_singleton<rc_singleton_test_class, singleton_tag_borrowed>;
+    REQUIRE(rc_singleton_test_class::instances() == 0);
+
+    {
+        borrowed a;
+        borrowed b = a;
+        borrowed c;
+        REQUIRE(rc_singleton_test_class::instances() == 1);
+        REQUIRE(a.get() == b.get());
+        REQUIRE(a.get() == c.get());
+        REQUIRE(&*a ==
+                reference_counted_singleton<rc_singleton_test_class,
+                                            singleton_tag_borrowed>()
+                    .get());
+    }
+
+    SECTION("the thread keeps its reference after its handles are gone") {
+        REQUIRE(rc_singleton_test_class::instances() == 1);
+        borrowed::release_thread_reference();
+        REQUIRE(rc_singleton_test_class::instances() == 0);
+    }
+
+    SECTION("release waits for the thread's handles") {
+        {
+            borrowed a;
+            borrowed::release_thread_reference();
+            REQUIRE(rc_singleton_test_class::instances() == 1);
+        }
+        REQUIRE(rc_singleton_test_class::instances() == 0);
+    }
+
+    SECTION("threads drop their references when they exit") {
+        borrowed::release_thread_reference();
+        std::vector<std::thread> threads;
+        std::atomic<int> mismatches{0};
+        auto shared = reference_counted_singleton<rc_singleton_test_class,
+                                                  singleton_tag_borrowed>();
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < 1000; ++i) {
+                    borrowed handle;
+                    if (handle.get() != shared.get()) {
+                        ++mismatches;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(mismatches == 0);
+        shared.reset();
+        REQUIRE(rc_singleton_test_class::instances() == 0);
+    }
+}
+
+namespace {
+
+struct sharded_counter {
+    std::atomic<long> count{0};
+};
+
+long total(const sharded_counter& c) {
+    return c.count.load();
+}
+
+} // namespace
+
+TEST_CASE("sharded singleton") {
+    using counters = sharded_singleton<sharded_counter>;
+    REQUIRE(counters::shard_count() >= 1);
+    REQUIRE(&counters::local() == &counters::local());
+
+    const int THREADS = 4;
+    const int INCREMENTS = 10000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([] {
+            for (int i = 0; i < INCREMENTS; ++i) {
+                counters::local().count.fetch_add(1,
+                                                  std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    counters::local().count += 5;
+
+    REQUIRE(counters::combine(0L, [](long sum, const sharded_counter& c) {
+                return sum + total(c);
+            }) == THREADS * INCREMENTS + 5);
+
+    std::size_t visited = 0;
+    counters::for_each([&](sharded_counter&) { ++visited; });
+    REQUIRE(visited == counters::shard_count());
+
+    // Different tags get different shards.
+    REQUIRE(&sharded_singleton<sharded_counter, singleton_tag_x>::local() !=
+            &counters::local());
+}
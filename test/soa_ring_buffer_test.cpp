@@ -0,0 +1,95 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <samwarring/simd_kernels.hpp>
+#include <samwarring/soa_ring_buffer.hpp>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace samwarring;
+
+namespace {
+
+template <class Column>
+auto to_vector(const Column& column) {
+    std::vector<typename Column::value_type> items;
+    for (auto part : {column.first_part(), column.second_part()}) {
+        items.insert(items.end(), part.begin(), part.end());
+    }
+    return items;
+}
+
+} // namespace
+
+TEST_CASE("soa ring buffer") {
+    soa_ring_buffer<std::int64_t, double, std::string> buf{3};
+    REQUIRE(buf.capacity() == 3);
+    REQUIRE(buf.empty());
+    REQUIRE(buf.column<1>().empty());
+
+    buf.push_back(1, 1.5, "a");
+    buf.push_back(2, 2.5, "b");
+    REQUIRE(buf.size() == 2);
+    REQUIRE_FALSE(buf.full());
+    REQUIRE(to_vector(buf.column<0>()) == std::vector<std::int64_t>{1, 2});
+    REQUIRE(buf.column<1>().second_part().size() == 0);
+
+    SECTION("overwrites the oldest record in every column") {
+        buf.push_back(3, 3.5, "c");
+        buf.push_back(4, 4.5, "d");
+        REQUIRE(buf.full());
+        REQUIRE(to_vector(buf.column<0>()) ==
+                std::vector<std::int64_t>{2, 3, 4});
+        REQUIRE(to_vector(buf.column<1>()) ==
+                std::vector<double>{2.5, 3.5, 4.5});
+        REQUIRE(to_vector(buf.column<2>()) ==
+                std::vector<std::string>{"b", "c", "d"});
+
+        auto values = buf.column<1>();
+        REQUIRE(values.first_part().size() == 2);
+        REQUIRE(values.second_part().size() == 1);
+        REQUIRE(values.front() == 2.5);
+        REQUIRE(values.back() == 4.5);
+        REQUIRE(values[1] == 3.5);
+    }
+
+    SECTION("element and row access") {
+        buf.get<2>(1) = "changed";
+        REQUIRE(buf.get<0>(1) == 2);
+        REQUIRE(buf.row(1) == std::make_tuple(2, 2.5, std::string{"changed"}));
+    }
+
+    SECTION("columns can be written through") {
+        auto ids = buf.column<0>();
+        for (auto& id : ids.first_part()) {
+            id *= 10;
+        }
+        REQUIRE(buf.get<0>(0) == 10);
+        REQUIRE(buf.get<0>(1) == 20);
+    }
+
+    SECTION("clear") {
+        buf.clear();
+        REQUIRE(buf.empty());
+        buf.push_back(5, 5.5, "e");
+        REQUIRE(to_vector(buf.column<2>()) == std::vector<std::string>{"e"});
+    }
+}
+
+TEST_CASE("simd kernels over soa columns") {
+    soa_ring_buffer<std::uint32_t, double, std::int32_t> buf{100};
+    for (int i = 0; i < 250; ++i) {
+        buf.push_back(static_cast<std::uint32_t>(i), i * 0.5, i);
+    }
+    // Items 150 through 249 remain, split across the end of the storage.
+    const auto& cbuf = buf;
+    REQUIRE(simd::sum(cbuf.column<2>()) == 19950);
+    REQUIRE(simd::sum(buf.column<1>()) == Approx(9975.0));
+    REQUIRE(simd::min_max(cbuf.column<2>()) == std::make_pair(150, 249));
+    REQUIRE(simd::count_greater(cbuf.column<2>(), 239) == 10);
+
+    std::vector<std::int32_t> kernel(100, 0);
+    kernel[0] = 1;
+    kernel[99] = 2;
+    REQUIRE(simd::dot(cbuf.column<2>(), kernel.data()) == 150 + 2 * 249);
+}
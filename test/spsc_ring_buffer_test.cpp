@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <samwarring/instance_tracker.hpp>
+#include <samwarring/spsc_ring_buffer.hpp>
+#include <samwarring/wait_strategy.hpp>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace samwarring;
+
+TEST_CASE("spsc ring buffer") {
+    spsc_ring_buffer<int> queue{3};
+    REQUIRE(queue.capacity() == 3);
+    REQUIRE(queue.empty());
+
+    SECTION("pop from empty queue fails") {
+        int item = -1;
+        REQUIRE_FALSE(queue.try_pop(item));
+        REQUIRE(item == -1);
+    }
+
+    SECTION("push until full") {
+        REQUIRE(queue.try_push(1));
+        REQUIRE(queue.try_push(2));
+        REQUIRE(queue.try_push(3));
+        REQUIRE_FALSE(queue.try_push(4));
+        REQUIRE(queue.size() == 3);
+
+        SECTION("pop in FIFO order") {
+            int item;
+            REQUIRE(queue.try_pop(item));
+            REQUIRE(item == 1);
+            REQUIRE(queue.try_pop(item));
+            REQUIRE(item == 2);
+            REQUIRE(queue.try_pop(item));
+            REQUIRE(item == 3);
+            REQUIRE_FALSE(queue.try_pop(item));
+            REQUIRE(queue.empty());
+        }
+
+        SECTION("wraps around") {
+            int item;
+            for (int i = 4; i < 20; ++i) {
+                REQUIRE(queue.try_pop(item));
+                REQUIRE(item == i - 3);
+                REQUIRE(queue.try_push(i));
+                REQUIRE(queue.size() == 3);
+            }
+        }
+    }
+}
+
+TEST_CASE("spsc ring buffer item lifetimes") {
+    auto stats = std::make_shared<instance_tracker_stats>();
+    {
+        spsc_ring_buffer<instance_tracker> queue{4};
+        REQUIRE(stats->instances == 0);
+
+        REQUIRE(queue.try_emplace(stats));
+        REQUIRE(queue.try_emplace(stats));
+        REQUIRE(queue.try_emplace(stats));
+        REQUIRE(stats->instances == 3);
+        REQUIRE(stats->all_copies == 0);
+
+        instance_tracker out{stats};
+        REQUIRE(queue.try_pop(out));
+        REQUIRE(out.id() == 1);
+        REQUIRE(stats->instances == 3);
+        REQUIRE(stats->move_assignments == 1);
+    }
+    SECTION("remaining items destroyed with the queue") {
+        REQUIRE(stats->instances == 0);
+    }
+}
+
+TEST_CASE("spsc ring buffer of strings") {
+    spsc_ring_buffer<std::string> queue{2};
+    std::string item{"platypus bear"};
+    REQUIRE(queue.try_push(std::move(item)));
+    REQUIRE(queue.try_push("tigerdillo"));
+
+    SECTION("failed push does not move from item") {
+        std::string rejected{"flying bison"};
+        REQUIRE_FALSE(queue.try_push(std::move(rejected)));
+        REQUIRE(rejected == "flying bison");
+    }
+
+    SECTION("pop") {
+        std::string out;
+        REQUIRE(queue.try_pop(out));
+        REQUIRE(out == "platypus bear");
+        REQUIRE(queue.try_pop(out));
+        REQUIRE(out == "tigerdillo");
+    }
+}
+
+TEST_CASE("spsc ring buffer batch consumer") {
+    spsc_ring_buffer<int> queue{4};
+    std::vector<std::vector<int>> spans;
+    auto collect = [&](int* begin, int* end) {
+        spans.emplace_back(begin, end);
+    };
+
+    SECTION("empty queue") {
+        REQUIRE(queue.consume_batch(10, collect) == 0);
+        REQUIRE(spans.empty());
+    }
+
+    SECTION("one contiguous span") {
+        queue.try_push(1);
+        queue.try_push(2);
+        queue.try_push(3);
+        REQUIRE(queue.consume_batch(2, collect) == 2);
+        REQUIRE(spans == std::vector<std::vector<int>>{{1, 2}});
+        REQUIRE(queue.size() == 1);
+    }
+
+    SECTION("two spans after wrapping around") {
+        for (int i = 1; i <= 4; ++i) {
+            queue.try_push(i);
+        }
+        int item;
+        queue.try_pop(item);
+        queue.try_pop(item);
+        queue.try_push(5);
+        queue.try_push(6);
+        REQUIRE(queue.consume_batch(10, collect) == 4);
+        // One slot is always left empty, so the storage has 5 slots.
+        REQUIRE(spans == std::vector<std::vector<int>>{{3, 4, 5}, {6}});
+        REQUIRE(queue.empty());
+    }
+
+    SECTION("throwing callback keeps its span") {
+        for (int i = 1; i <= 4; ++i) {
+            queue.try_push(i);
+        }
+        int item;
+        queue.try_pop(item);
+        queue.try_pop(item);
+        queue.try_pop(item);
+        queue.try_push(5);
+        queue.try_push(6);
+        int calls = 0;
+        REQUIRE_THROWS(queue.consume_batch(10, [&](int*, int*) {
+            if (++calls == 2) {
+                throw std::runtime_error{"second span"};
+            }
+        }));
+        REQUIRE(queue.size() == 1);
+        REQUIRE(queue.try_pop(item));
+        REQUIRE(item == 6);
+    }
+}
+
+TEST_CASE("spsc ring buffer batch consumer item lifetimes") {
+    auto stats = std::make_shared<instance_tracker_stats>();
+    spsc_ring_buffer<instance_tracker> queue{4};
+    queue.try_emplace(stats);
+    queue.try_emplace(stats);
+    queue.try_emplace(stats);
+
+    std::vector<instance_tracker> moved;
+    queue.consume_batch(2, [&](instance_tracker* begin, instance_tracker* end) {
+        std::move(begin, end, std::back_inserter(moved));
+    });
+    REQUIRE(moved.size() == 2);
+    REQUIRE(stats->instances == 3);
+    REQUIRE(queue.size() == 1);
+}
+
+TEST_CASE("threaded spsc ring buffer") {
+    const int NUM_ITEMS = 100000;
+    spsc_ring_buffer<int> queue{64};
+
+    std::thread producer{[&] {
+        for (int i = 0; i < NUM_ITEMS; ++i) {
+            while (!queue.try_push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    }};
+
+    std::vector<int> received;
+    received.reserve(NUM_ITEMS);
+    while (received.size() < NUM_ITEMS) {
+        int item;
+        if (queue.try_pop(item)) {
+            received.push_back(item);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    bool in_order = true;
+    for (int i = 0; i < NUM_ITEMS; ++i) {
+        in_order = in_order && (received[i] == i);
+    }
+    REQUIRE(in_order);
+    REQUIRE(queue.empty());
+}
+
+#if defined(__linux__)
+#define SAMWARRING_TEST_WAIT_STRATEGIES spin_yield<>, timed_wait<>, spin_futex<>
+#else
+#define SAMWARRING_TEST_WAIT_STRATEGIES spin_yield<>, timed_wait<>
+#endif
+
+TEMPLATE_TEST_CASE("blocking spsc ring buffer", "",
+                   SAMWARRING_TEST_WAIT_STRATEGIES) {
+    const int NUM_ITEMS = 100000;
+    spsc_ring_buffer<int, TestType> queue{64};
+
+    std::thread producer{[&] {
+        for (int i = 0; i < NUM_ITEMS; ++i) {
+            queue.push(i);
+        }
+    }};
+
+    bool in_order = true;
+    for (int i = 0; i < NUM_ITEMS; ++i) {
+        int item;
+        queue.pop(item);
+        in_order = in_order && (item == i);
+    }
+    producer.join();
+    REQUIRE(in_order);
+    REQUIRE(queue.empty());
+}
+
+TEMPLATE_TEST_CASE("spsc ring buffer timed waits", "", busy_spin,
+                   SAMWARRING_TEST_WAIT_STRATEGIES) {
+    spsc_ring_buffer<int, TestType> queue{1};
+    const auto timeout = std::chrono::milliseconds{5};
+    int item = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    REQUIRE_FALSE(queue.try_pop_until(item, start + timeout));
+    REQUIRE(std::chrono::steady_clock::now() - start >= timeout);
+
+    REQUIRE(queue.try_push_until(1, start + timeout));
+    start = std::chrono::steady_clock::now();
+    REQUIRE_FALSE(queue.try_push_until(2, start + timeout));
+    REQUIRE(std::chrono::steady_clock::now() - start >= timeout);
+
+    REQUIRE(queue.try_pop_until(item, std::chrono::steady_clock::now()));
+    REQUIRE(item == 1);
+}
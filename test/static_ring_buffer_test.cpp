@@ -0,0 +1,97 @@
+#include <catch2/catch.hpp>
+#include <samwarring/static_ring_buffer.hpp>
+#include <string>
+#include <vector>
+
+using namespace samwarring;
+
+namespace {
+
+template <std::size_t N>
+constexpr int sum_of_last_n(int count) {
+    static_ring_buffer<int, N> buf;
+    for (int i = 1; i <= count; ++i) {
+        buf.push_back(i);
+    }
+    int sum = 0;
+    for (int item : buf) {
+        sum += item;
+    }
+    return sum;
+}
+
+} // namespace
+
+TEST_CASE("static ring buffer constant evaluation") {
+    // Power-of-two capacity uses a mask, others use compare-and-subtract.
+    static_assert(sum_of_last_n<4>(10) == 7 + 8 + 9 + 10);
+    static_assert(sum_of_last_n<3>(10) == 8 + 9 + 10);
+    static_assert(sum_of_last_n<5>(2) == 1 + 2);
+    SUCCEED();
+}
+
+TEST_CASE("static ring buffer") {
+    static_ring_buffer<int, 4> buf;
+    REQUIRE(buf.capacity() == 4);
+
+    SECTION("without rollover") {
+        buf.push_back(1);
+        buf.push_back(2);
+        REQUIRE(buf.front() == 0);
+        REQUIRE(buf.back() == 2);
+        REQUIRE(buf[0] == 0);
+        REQUIRE(buf[1] == 0);
+        REQUIRE(buf[2] == 1);
+        REQUIRE(buf[3] == 2);
+    }
+
+    SECTION("with rollover") {
+        for (int i = 1; i <= 5; ++i) {
+            buf.push_back(i);
+        }
+        REQUIRE(buf.front() == 2);
+        REQUIRE(buf.back() == 5);
+        REQUIRE(buf[0] == 2);
+        REQUIRE(buf[3] == 5);
+
+        SECTION("iteration") {
+            std::vector<int> expected{2, 3, 4, 5};
+            REQUIRE(std::equal(buf.begin(), buf.end(), expected.begin()));
+        }
+
+        SECTION("partitioned iteration") {
+            std::vector<int> expected{2, 3, 4, 5};
+            std::vector<int> actual;
+            for (auto i : buf.first_part()) {
+                actual.push_back(i);
+            }
+            for (auto i : buf.second_part()) {
+                actual.push_back(i);
+            }
+            REQUIRE(actual == expected);
+        }
+
+        SECTION("copy") {
+            auto buf2 = buf;
+            buf2.push_back(7);
+            REQUIRE(buf[0] == 2);
+            REQUIRE(buf2[0] == 3);
+            REQUIRE(buf2.back() == 7);
+        }
+    }
+}
+
+TEST_CASE("static ring buffer with non-power-of-two capacity") {
+    static_ring_buffer<std::string, 3> buf;
+    buf.push_back("poodle monkey");
+    buf.push_back("platypus bear");
+    buf.push_back("tigerdillo");
+    buf.push_back("flying bison");
+
+    const auto& cbuf = buf;
+    std::vector<std::string> expected{"platypus bear", "tigerdillo",
+                                      "flying bison"};
+    REQUIRE(std::equal(cbuf.begin(), cbuf.end(), expected.begin()));
+    REQUIRE(cbuf.front() == "platypus bear");
+    REQUIRE(cbuf.back() == "flying bison");
+}
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <samwarring/time_window_ring.hpp>
+#include <stdexcept>
+#include <vector>
+
+using namespace samwarring;
+using std::chrono::seconds;
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+clock_type::time_point at(int s) {
+    return clock_type::time_point{seconds{s}};
+}
+
+// Copyable value whose copy throws once a countdown of copies runs out.
+struct flaky_value {
+    static int copies_left;
+
+    explicit flaky_value(int v) : value{v} {}
+
+    flaky_value(const flaky_value& other) : value{other.value} {
+        if (copies_left-- == 0) {
+            throw std::runtime_error{"copy failed"};
+        }
+    }
+
+    flaky_value& operator=(const flaky_value&) = default;
+
+    bool operator<(const flaky_value& other) const noexcept {
+        return value < other.value;
+    }
+
+    int value;
+};
+
+int flaky_value::copies_left = -1;
+
+} // namespace
+
+TEST_CASE("time window ring evicts by age") {
+    time_window_ring<int> ring{seconds{10}, 100, 4};
+    REQUIRE(ring.empty());
+    REQUIRE(ring.window() == seconds{10});
+
+    ring.push_back(1, at(0));
+    ring.push_back(2, at(3));
+    ring.push_back(3, at(9));
+    REQUIRE(ring.count(at(9)) == 3);
+    REQUIRE(ring.count(at(10)) == 2);
+    REQUIRE(ring.front().value == 2);
+    REQUIRE(ring.front().time == at(3));
+
+    // Pushing evicts too.
+    ring.push_back(4, at(18));
+    REQUIRE(ring.size() == 2);
+    REQUIRE(ring.front().value == 3);
+    REQUIRE(ring.back().value == 4);
+
+    REQUIRE(ring.count(at(100)) == 0);
+    REQUIRE(ring.empty());
+}
+
+TEST_CASE("time window ring rate") {
+    time_window_ring<int> ring{seconds{2}, 100};
+    for (int i = 0; i < 10; ++i) {
+        ring.push_back(i, at(1));
+    }
+    REQUIRE(ring.rate(at(1)) == Approx(5.0));
+    REQUIRE(ring.rate(at(3)) == Approx(0.0));
+}
+
+TEST_CASE("time window ring grows and shrinks within bounds") {
+    time_window_ring<int> ring{seconds{10}, 64, 4};
+    REQUIRE(ring.capacity() == 4);
+
+    for (int i = 0; i < 50; ++i) {
+        ring.push_back(i, at(0));
+    }
+    REQUIRE(ring.capacity() == 64);
+    REQUIRE(ring.size() == 50);
+    REQUIRE(ring.dropped() == 0);
+
+    SECTION("bounded at max capacity") {
+        for (int i = 50; i < 100; ++i) {
+            ring.push_back(i, at(1));
+        }
+        REQUIRE(ring.capacity() == 64);
+        REQUIRE(ring.size() == 64);
+        REQUIRE(ring.dropped() == 36);
+        REQUIRE(ring.front().value == 36);
+        REQUIRE(ring.back().value == 99);
+    }
+
+    SECTION("shrinks once mostly expired") {
+        for (int i = 0; i < 3; ++i) {
+            ring.push_back(i, at(5));
+        }
+        REQUIRE(ring.count(at(10)) == 3);
+        REQUIRE(ring.capacity() == 8);
+        ring.evict_expired(at(10));
+        REQUIRE(ring.capacity() == 8);
+
+        std::vector<int> values;
+        for (const auto& e : ring) {
+            values.push_back(e.value);
+        }
+        REQUIRE(values == std::vector<int>{0, 1, 2});
+    }
+
+    SECTION("clear") {
+        ring.clear();
+        REQUIRE(ring.empty());
+        REQUIRE(ring.capacity() == 4);
+    }
+}
+
+TEST_CASE("time window ring percentiles") {
+    time_window_ring<int, clock_type, true> ring{seconds{10}, 1000};
+    for (int i = 1; i <= 100; ++i) {
+        ring.push_back(101 - i, at(0));
+    }
+    REQUIRE(ring.percentile(0.0, at(0)) == 1);
+    REQUIRE(ring.percentile(0.5, at(0)) == 50);
+    REQUIRE(ring.percentile(0.99, at(0)) == 99);
+    REQUIRE(ring.percentile(1.0, at(0)) == 100);
+
+    ring.push_back(1000, at(5));
+    REQUIRE(ring.percentile(1.0, at(5)) == 1000);
+    REQUIRE(ring.percentile(0.5, at(10)) == 1000);
+}
+
+TEST_CASE("time window ring percentiles match a rescan") {
+    time_window_ring<int, clock_type, true> ring{seconds{10}, 200, 8};
+    std::vector<std::pair<int, int>> history;
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<int> value{0, 50};
+    std::uniform_int_distribution<int> step{0, 2};
+
+    bool all_match = true;
+    int now = 0;
+    for (int i = 0; i < 2000; ++i) {
+        now += step(rng);
+        const int v = value(rng);
+        ring.push_back(v, at(now));
+        history.emplace_back(now, v);
+
+        std::vector<int> expected;
+        for (auto it = history.rbegin(); it != history.rend(); ++it) {
+            if (it->first <= now - 10 || expected.size() == 200) {
+                break;
+            }
+            expected.push_back(it->second);
+        }
+        std::sort(expected.begin(), expected.end());
+        const std::size_t n = expected.size();
+        all_match = all_match && ring.size() == n;
+        for (double p : {0.0, 0.25, 0.5, 0.9, 1.0}) {
+            const double rank = std::ceil(p * static_cast<double>(n));
+            const std::size_t index =
+                rank < 1 ? 0 : static_cast<std::size_t>(rank) - 1;
+            all_match = all_match && ring.percentile(p, at(now)) ==
+                                         expected[std::min(index, n - 1)];
+        }
+    }
+    REQUIRE(all_match);
+}
+
+TEST_CASE("time window ring rejects bad arguments") {
+    REQUIRE_THROWS_AS(time_window_ring<int>(seconds{0}, 10),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(time_window_ring<int>(seconds{1}, 0),
+                      std::invalid_argument);
+}
+
+TEST_CASE("time window ring percentiles over many chunks") {
+    // Large enough that the sorted values span many chunks, which are split
+    // and merged as the window fills and drains.
+    const std::size_t MAX = 6000;
+    time_window_ring<int, clock_type, true> ring{seconds{10}, MAX, 8};
+    std::vector<std::pair<int, int>> history;
+    std::mt19937 rng{7};
+    std::uniform_int_distribution<int> value{0, 3000};
+    std::uniform_int_distribution<int> burst{0, 900};
+
+    int now = 0;
+    for (int second = 0; second < 40; ++second) {
+        // Alternates busy and quiet seconds, so the window grows and shrinks.
+        const int pushes = second % 10 < 5 ? burst(rng) : burst(rng) / 20;
+        for (int i = 0; i < pushes; ++i) {
+            const int v = value(rng);
+            ring.push_back(v, at(now));
+            history.emplace_back(now, v);
+        }
+        ++now;
+
+        std::vector<int> expected;
+        for (auto it = history.rbegin(); it != history.rend(); ++it) {
+            if (it->first <= now - 10 || expected.size() == MAX) {
+                break;
+            }
+            expected.push_back(it->second);
+        }
+        std::sort(expected.begin(), expected.end());
+        REQUIRE(ring.count(at(now)) == expected.size());
+        for (std::size_t i = 0; i < expected.size(); i += 37) {
+            const double p = (i + 0.5) / expected.size();
+            INFO("second " << second << ", rank " << i);
+            REQUIRE(ring.percentile(p, at(now)) == expected[i]);
+        }
+    }
+}
+
+TEST_CASE("time window ring percentiles survive a failed push") {
+    using ring_type = time_window_ring<flaky_value, clock_type, true>;
+    const flaky_value one{1};
+    const flaky_value five{5};
+    const flaky_value nine{9};
+    auto make_ring = [&] {
+        ring_type ring{seconds{10}, 100, 4};
+        ring.push_back(one, at(0));
+        ring.push_back(five, at(1));
+        return ring;
+    };
+
+    // Counts the copies of a push on a twin, then fails the last of them,
+    // which puts the entry into the ring after the sorted copy has taken
+    // the value.
+    ring_type twin = make_ring();
+    flaky_value::copies_left = 1000;
+    twin.push_back(nine, at(2));
+    const int copies = 1000 - flaky_value::copies_left;
+
+    ring_type ring = make_ring();
+    flaky_value::copies_left = copies - 1;
+    REQUIRE_THROWS_AS(ring.push_back(nine, at(2)), std::runtime_error);
+    flaky_value::copies_left = -1;
+
+    REQUIRE(ring.count(at(2)) == 2);
+    REQUIRE(ring.percentile(1.0, at(2)).value == 5);
+    REQUIRE(ring.percentile(0.0, at(2)).value == 1);
+    REQUIRE(ring.count(at(11)) == 0);
+}
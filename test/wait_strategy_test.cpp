@@ -0,0 +1,45 @@
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <samwarring/wait_strategy.hpp>
+#include <thread>
+
+using namespace samwarring;
+
+#if defined(__linux__)
+#define SAMWARRING_TEST_WAIT_STRATEGIES                                        \
+    busy_spin, spin_yield<>, timed_wait<>, spin_futex<>
+#else
+#define SAMWARRING_TEST_WAIT_STRATEGIES busy_spin, spin_yield<>, timed_wait<>
+#endif
+
+TEMPLATE_TEST_CASE("wait strategy", "", SAMWARRING_TEST_WAIT_STRATEGIES) {
+    TestType strategy;
+    std::atomic<bool> ready{false};
+    auto is_ready = [&] { return ready.load(std::memory_order_acquire); };
+
+    SECTION("returns immediately when ready") {
+        ready = true;
+        strategy.wait(is_ready);
+        REQUIRE(strategy.wait_until(is_ready,
+                                    std::chrono::steady_clock::now()));
+    }
+
+    SECTION("times out") {
+        const auto start = std::chrono::steady_clock::now();
+        const auto timeout = std::chrono::milliseconds{5};
+        REQUIRE_FALSE(strategy.wait_until(is_ready, start + timeout));
+        REQUIRE(std::chrono::steady_clock::now() - start >= timeout);
+    }
+
+    SECTION("wakes when notified") {
+        std::thread notifier{[&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds{2});
+            ready.store(true, std::memory_order_release);
+            strategy.notify();
+        }};
+        strategy.wait(is_ready);
+        notifier.join();
+        REQUIRE(ready);
+    }
+}
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <samwarring/windowed_stats_ring.hpp>
+#include <vector>
+
+using namespace samwarring;
+
+TEST_CASE("windowed stats ring") {
+    windowed_stats_ring<int> stats{3};
+    REQUIRE(stats.size() == 0);
+
+    SECTION("partially filled window") {
+        stats.push_back(4);
+        stats.push_back(2);
+        REQUIRE(stats.size() == 2);
+        REQUIRE(stats.sum() == 6);
+        REQUIRE(stats.mean() == Approx(3.0));
+        REQUIRE(stats.variance() == Approx(1.0));
+        REQUIRE(stats.min() == 2);
+        REQUIRE(stats.max() == 4);
+    }
+
+    SECTION("oldest values leave the window") {
+        for (int i : {9, 1, 5, 3, 7}) {
+            stats.push_back(i);
+        }
+        // Window is [5, 3, 7]
+        REQUIRE(stats.size() == 3);
+        REQUIRE(stats.sum() == 15);
+        REQUIRE(stats.mean() == Approx(5.0));
+        REQUIRE(stats.variance() == Approx(8.0 / 3.0));
+        REQUIRE(stats.min() == 3);
+        REQUIRE(stats.max() == 7);
+    }
+
+    SECTION("repeated extreme values") {
+        for (int i : {5, 5, 5, 1}) {
+            stats.push_back(i);
+        }
+        REQUIRE(stats.max() == 5);
+        stats.push_back(1);
+        REQUIRE(stats.max() == 5);
+        stats.push_back(1);
+        REQUIRE(stats.max() == 1);
+        REQUIRE(stats.min() == 1);
+    }
+
+    SECTION("increasing run longer than the window") {
+        for (int i : {1, 2, 3, 4}) {
+            stats.push_back(i);
+        }
+        REQUIRE(stats.min() == 2);
+        REQUIRE(stats.max() == 4);
+    }
+
+    SECTION("decreasing run longer than the window") {
+        for (int i : {4, 3, 2, 1}) {
+            stats.push_back(i);
+        }
+        REQUIRE(stats.min() == 1);
+        REQUIRE(stats.max() == 3);
+    }
+}
+
+TEST_CASE("windowed stats ring matches a rescan") {
+    const std::size_t WINDOW = 17;
+    windowed_stats_ring<double> stats{WINDOW};
+    std::vector<double> history;
+    std::mt19937 rng{1234};
+    std::uniform_real_distribution<double> dist{-100.0, 100.0};
+
+    for (int i = 0; i < 1000; ++i) {
+        double value = dist(rng);
+        stats.push_back(value);
+        history.push_back(value);
+
+        auto first = history.size() > WINDOW ? history.end() - WINDOW
+                                              : history.begin();
+        double sum = std::accumulate(first, history.end(), 0.0);
+        double mean = sum / (history.end() - first);
+        double sq = 0;
+        for (auto it = first; it != history.end(); ++it) {
+            sq += (*it - mean) * (*it - mean);
+        }
+        double variance = sq / (history.end() - first);
+
+        INFO("push " << i);
+        REQUIRE(stats.sum() == Approx(sum).margin(1e-9));
+        REQUIRE(stats.variance() == Approx(variance).epsilon(1e-6));
+        REQUIRE(stats.min() == *std::min_element(first, history.end()));
+        REQUIRE(stats.max() == *std::max_element(first, history.end()));
+    }
+}
+
+TEST_CASE("windowed stats ring of unsigned values") {
+    windowed_stats_ring<std::uint8_t> stats{2};
+    stats.push_back(250);
+    stats.push_back(250);
+    stats.push_back(255);
+    REQUIRE(stats.sum() == 505u);
+    REQUIRE(stats.max() == 255);
+    REQUIRE(stats.min() == 250);
+}
+
+TEMPLATE_TEST_CASE("windowed stats ring variance with a large mean", "",
+                   std::int64_t, double) {
+    // The squared values are far beyond 2^53, so a running sum of squares
+    // would round on every push, and its error would grow without bound.
+    const std::size_t WINDOW = 8;
+    windowed_stats_ring<TestType> stats{WINDOW};
+    std::vector<TestType> history;
+    std::mt19937 rng{99};
+    std::uniform_int_distribution<int> offset{0, 999};
+
+    for (int i = 0; i < 300000; ++i) {
+        const TestType value = static_cast<TestType>(1000000000 + offset(rng));
+        stats.push_back(value);
+        history.push_back(value);
+    }
+
+    const auto first = history.end() - WINDOW;
+    double mean = 0;
+    for (auto it = first; it != history.end(); ++it) {
+        mean += static_cast<double>(*it) / WINDOW;
+    }
+    double sq = 0;
+    for (auto it = first; it != history.end(); ++it) {
+        sq += (static_cast<double>(*it) - mean) *
+              (static_cast<double>(*it) - mean);
+    }
+    REQUIRE(stats.mean() == Approx(mean).epsilon(1e-12));
+    REQUIRE(stats.variance() == Approx(sq / WINDOW).epsilon(1e-9));
+}